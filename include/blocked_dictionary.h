@@ -0,0 +1,326 @@
+//! This class implements a sorted Dictionary split in blocks.
+
+
+#ifndef _BLOCKED_DICTIONARY_H_
+#define _BLOCKED_DICTIONARY_H_
+
+#include <stdexcept>  // std::out_of_range
+#include <functional> // std::less<>()
+#include <algorithm>  // std::lower_bound(), std::upper_bound(), std::stable_sort()
+#include <utility>    // std::pair, std::move(), std::forward()
+#include <vector>     // std::vector
+
+#include "dal_storage.h"
+
+/// This class implements a sorted dictionary stored as a sequence of fixed-size sorted blocks.
+/*!
+ * Keys are kept in order across a list of blocks of at most `BlockSize` entries
+ * (like the leaves of a B+tree), and a small index holds the smallest key of
+ * every block. A lookup binary searches the index and then one block; an
+ * insertion or removal shifts entries inside a single block only, so it costs
+ * O(BlockSize + n / BlockSize) instead of the O(n) of DSAL. A full block is
+ * split in two halves; a block that gets too sparse is merged with a neighbour.
+ *
+ * Inside a block keys and data are kept in separate arrays, so the binary
+ * search over a block touches only keys.
+ *
+ * @tparam KeyType The key type.
+ * @tparam DataType Tha data type to be stored in the dictionary.
+ * @tparam KeyTypeLess A functor/function pointer that compares two keys for strict order <.
+ * @tparam BlockSize Most entries a block holds.
+ */
+template < typename KeyType, typename DataType, typename KeyTypeLess = std::less< KeyType >, size_t BlockSize = 256 >
+class BlockedDictionary
+{
+    static_assert( BlockSize >= 4, "Blocks must hold at least four entries." );
+
+    protected:
+        //=== Alias
+        /// Alias that defines a table item.
+        typedef std::pair< KeyType, DataType > entry_type;
+        /// Alias for the storage handle of a block.
+        typedef SplitStorage< KeyType, DataType > storage_type;
+
+        static constexpr size_t SIZE=50; //!< Default capacity.
+
+        /// A block owns room for BlockSize entries, of which the first `length` are constructed and sorted.
+        struct Block {
+            storage_type items; //!< Keys and data.
+            size_t length;      //!< Number of entries.
+
+            Block() : length{ 0 } { items.allocate( BlockSize ); }
+            Block( const Block & other ) : length{ 0 } {
+                items.allocate( BlockSize );
+                try {
+                    items.copy_from( other.items, other.length );
+                } catch ( ... ) {
+                    items.deallocate( BlockSize );
+                    throw;
+                }
+                length = other.length;
+            }
+            Block( Block && other ) noexcept : items{ other.items }, length{ other.length } {
+                other.items = storage_type();
+                other.length = 0;
+            }
+            Block & operator=( Block other ){
+                items.swap( other.items );
+                std::swap( length, other.length );
+                return *this;
+            }
+            ~Block(){
+                items.destroy( 0, length );
+                items.deallocate( BlockSize );
+            }
+            /// Index of the first key not less than `_mKey`.
+            size_t lower_bound( const KeyType & _mKey ) const{
+                return std::lower_bound( items.keys(), items.keys() + length, _mKey, KeyTypeLess() ) - items.keys();
+            }
+            /// Index of the first key greater than `_mKey`.
+            size_t upper_bound( const KeyType & _mKey ) const{
+                return std::upper_bound( items.keys(), items.keys() + length, _mKey, KeyTypeLess() ) - items.keys();
+            }
+        };
+
+        size_t m_length;                //!< Number of entries.
+        std::vector< Block > m_blocks;  //!< The blocks, in key order; none is empty.
+        std::vector< KeyType > m_mins;  //!< Smallest key of each block (the index).
+
+        /// Index of the block where `_mKey` is or would be: the last one whose smallest key is not greater than it (or the first).
+        size_t find_block( const KeyType & _mKey ) const{
+            size_t b = std::upper_bound( m_mins.begin(), m_mins.end(), _mKey, KeyTypeLess() ) - m_mins.begin();
+            return b == 0 ? 0 : b - 1;
+        }
+        /// Returns true if `_mKey` is stored, with its block in `b` and its position in `pos`.
+        /*!
+         * On a miss (b, pos) is where the key should go. The dictionary must not be empty.
+         */
+        bool locate( const KeyType & _mKey, size_t & b, size_t & pos ) const{
+            KeyTypeLess less;
+            b = find_block( _mKey );
+            const Block & block = m_blocks[b];
+            pos = block.lower_bound( _mKey );
+            return pos < block.length and not less( _mKey, block.items.key(pos) );
+        }
+        /// Moves the upper half of the full block `b` into a new block right after it.
+        void split( size_t b ){
+            Block upper;
+            Block & lower = m_blocks[b];
+            size_t half = lower.length / 2;
+            for ( size_t i = half; i < lower.length; ++i )
+                upper.items.construct( i - half, std::move( lower.items.key(i) ), std::move( lower.items.data(i) ) );
+            upper.length = lower.length - half;
+            lower.items.destroy( half, lower.length );
+            lower.length = half;
+            m_mins.insert( m_mins.begin() + b + 1, upper.items.key(0) );
+            m_blocks.insert( m_blocks.begin() + b + 1, std::move( upper ) );
+        }
+        /// Appends the entries of block `b + 1` to block `b` and drops it (they must fit).
+        void merge( size_t b ){
+            Block & into = m_blocks[b];
+            Block & from = m_blocks[b + 1];
+            for ( size_t i = 0; i < from.length; ++i )
+                into.items.construct( into.length + i, std::move( from.items.key(i) ), std::move( from.items.data(i) ) );
+            into.length += from.length;
+            m_blocks.erase( m_blocks.begin() + b + 1 );
+            m_mins.erase( m_mins.begin() + b + 1 );
+        }
+        /// Makes position (b, pos) available for a new entry, splitting the block if it is full.
+        /*!
+         * On return slot `pos` of block `b` holds no constructed entry.
+         */
+        void open_slot( size_t & b, size_t & pos ){
+            if ( m_blocks.empty() ) {
+                m_blocks.emplace_back();
+                m_mins.emplace_back();
+                b = pos = 0;
+                return;
+            }
+            if ( m_blocks[b].length == BlockSize ) {
+                split( b );
+                size_t half = m_blocks[b].length;
+                if ( pos > half ) {
+                    ++b;
+                    pos -= half;
+                }
+            }
+            m_blocks[b].items.shift_right( pos, m_blocks[b].length );
+        }
+
+    public:
+        //=== Alias
+        typedef KeyType key_type;   //!< The key type.
+        typedef DataType data_type; //!< The data type.
+
+        //=== special members.
+        /// Default constructor; reserves the index for `capacity_` entries.
+        BlockedDictionary ( size_t capacity_ = SIZE ) : m_length{ 0 } {
+            m_blocks.reserve( capacity_ / BlockSize + 1 );
+            m_mins.reserve( capacity_ / BlockSize + 1 );
+        }
+        /// Range constructor: builds the dictionary from the (key, data) pairs in [first, last).
+        /*!
+         * When a key appears more than once the last occurrence wins.
+         */
+        template < typename InputIt >
+        BlockedDictionary ( InputIt first, InputIt last ) : m_length{ 0 } {
+            assign( first, last );
+        }
+        /// Destructor
+        virtual ~BlockedDictionary () { /* empty */ }
+        /// Copy and move constructors and assignment.
+        BlockedDictionary ( const BlockedDictionary & other ) = default;
+        BlockedDictionary ( BlockedDictionary && other ) noexcept
+            : m_length{ other.m_length }, m_blocks{ std::move( other.m_blocks ) }, m_mins{ std::move( other.m_mins ) }
+        {
+            other.m_length = 0;
+        }
+        BlockedDictionary & operator= ( BlockedDictionary other ){
+            swap( other );
+            return *this;
+        }
+        /// Exchanges the contents of two dictionaries in O(1).
+        void swap ( BlockedDictionary & other ) noexcept{
+            std::swap( m_length, other.m_length );
+            m_blocks.swap( other.m_blocks );
+            m_mins.swap( other.m_mins );
+        }
+
+        //=== status members
+        size_t size (void) const { return m_length; }
+        bool empty (void) const { return m_length == 0; }
+        /// Number of entries the current blocks hold.
+        size_t capacity (void) const { return m_blocks.size() * BlockSize; }
+
+        //=== bulk modifiers
+        /// Replaces the contents with the (key, data) pairs in [first, last), in O(n log n).
+        /*!
+         * Blocks are filled to three quarters, so the first insertions after a load do not split.
+         * When a key appears more than once the last occurrence wins.
+         */
+        template < typename InputIt >
+        void assign( InputIt first, InputIt last ){
+            KeyTypeLess less;
+            std::vector< entry_type > batch( first, last );
+            std::stable_sort( batch.begin(), batch.end(),
+                    [&less]( const entry_type & a, const entry_type & b ) { return less( a.first, b.first ); } );
+            const size_t fill = BlockSize - BlockSize / 4;
+            std::vector< Block > blocks;
+            std::vector< KeyType > mins;
+            size_t length = 0;
+            for ( size_t i = 0; i < batch.size(); ++i ) {
+                if ( i + 1 < batch.size() and not less( batch[i].first, batch[i + 1].first ) )
+                    continue; // A later entry has the same key.
+                if ( blocks.empty() or blocks.back().length == fill ) {
+                    blocks.emplace_back();
+                    mins.push_back( batch[i].first );
+                }
+                Block & block = blocks.back();
+                block.items.construct( block.length++, std::move( batch[i].first ), std::move( batch[i].second ) );
+                ++length;
+            }
+            m_blocks.swap( blocks );
+            m_mins.swap( mins );
+            m_length = length;
+        }
+
+        //=== acess members
+        bool search (const KeyType & key, DataType & data) const{
+            size_t b, pos;
+            if ( empty() or not locate( key, b, pos ) ) return false;
+            data = m_blocks[b].items.data(pos);
+            return true;
+        }
+        KeyType min (void) const{
+            if ( empty() ) throw std::out_of_range("INVALID");
+            return m_mins.front();
+        }
+        KeyType max (void) const{
+            if ( empty() ) throw std::out_of_range("INVALID");
+            const Block & last = m_blocks.back();
+            return last.items.key( last.length - 1 );
+        }
+        /// Retrieves the largest key less than `_mKey` (which need not be stored); false if there is none.
+        bool predecessor (const KeyType & _mKey, KeyType & _newKey) const{
+            size_t b = std::lower_bound( m_mins.begin(), m_mins.end(), _mKey, KeyTypeLess() ) - m_mins.begin();
+            if ( b == 0 ) return false;
+            const Block & block = m_blocks[b - 1];
+            _newKey = block.items.key( block.lower_bound( _mKey ) - 1 );
+            return true;
+        }
+        /// Retrieves the smallest key greater than `_mKey` (which need not be stored); false if there is none.
+        bool successor (const KeyType & _mKey, KeyType & _newKey) const{
+            if ( empty() ) return false;
+            size_t b = find_block( _mKey );
+            size_t pos = m_blocks[b].upper_bound( _mKey );
+            if ( pos == m_blocks[b].length ) {
+                if ( ++b == m_blocks.size() ) return false;
+                pos = 0;
+            }
+            _newKey = m_blocks[b].items.key(pos);
+            return true;
+        }
+
+        //=== modifier members.
+        /// Inserts a new entry; if the key already exists its data is overwritten and false is returned.
+        bool insert(const KeyType & _newKey, const DataType & _newInfo){
+            return emplace( _newKey, _newInfo );
+        }
+        /// Inserts a new entry moving key and data in; see insert(const KeyType &, const DataType &).
+        bool insert(KeyType && _newKey, DataType && _newInfo){
+            return emplace( std::move( _newKey ), std::move( _newInfo ) );
+        }
+        /// Inserts `_newKey` with data constructed from `args`; if the key exists its data is replaced and false is returned.
+        template < typename K, typename... Args >
+        bool emplace(K && _newKey, Args &&... args){
+            size_t b = 0, pos = 0;
+            if ( not empty() and locate( _newKey, b, pos ) ) {
+                m_blocks[b].items.data(pos) = DataType( std::forward< Args >( args )... );
+                return false;
+            }
+            return place( b, pos, std::forward< K >( _newKey ), DataType( std::forward< Args >( args )... ) );
+        }
+        /// Like emplace(), but leaves an existing entry untouched (and `args` unused) if the key is already stored.
+        template < typename K, typename... Args >
+        bool try_emplace(K && _newKey, Args &&... args){
+            size_t b = 0, pos = 0;
+            if ( not empty() and locate( _newKey, b, pos ) ) return false;
+            return place( b, pos, std::forward< K >( _newKey ), DataType( std::forward< Args >( args )... ) );
+        }
+        bool remove(const KeyType & _newKey, DataType & _newInfo){
+            size_t b, pos;
+            if ( empty() or not locate( _newKey, b, pos ) ) return false;
+            Block & block = m_blocks[b];
+            _newInfo = std::move( block.items.data(pos) );
+            block.items.shift_left( pos, block.length );
+            block.length--;
+            m_length--;
+            if ( block.length == 0 ) {
+                m_blocks.erase( m_blocks.begin() + b );
+                m_mins.erase( m_mins.begin() + b );
+                return true;
+            }
+            if ( pos == 0 ) m_mins[b] = block.items.key(0);
+            // Keep blocks at least a quarter full by merging small neighbours.
+            if ( block.length < BlockSize / 4 ) {
+                if ( b + 1 < m_blocks.size() and block.length + m_blocks[b + 1].length <= BlockSize / 2 ) merge( b );
+                else if ( b > 0 and block.length + m_blocks[b - 1].length <= BlockSize / 2 ) merge( b - 1 );
+            }
+            return true;
+        }
+
+    protected:
+        /// Constructs a new entry at (b, pos), as found by locate().
+        template < typename K >
+        bool place( size_t b, size_t pos, K && _newKey, DataType && data ){
+            open_slot( b, pos );
+            Block & block = m_blocks[b];
+            block.items.construct( pos, std::forward< K >( _newKey ), std::move( data ) );
+            block.length++;
+            if ( pos == 0 ) m_mins[b] = block.items.key(0);
+            m_length++;
+            return true;
+        }
+};
+
+#endif
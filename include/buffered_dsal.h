@@ -0,0 +1,435 @@
+//! This class implements a sorted Dictionary with a write buffer.
+
+
+#ifndef _BUFFERED_DSAL_H_
+#define _BUFFERED_DSAL_H_
+
+#include <stdexcept>  // std::out_of_range
+#include <functional> // std::less<>()
+#include <algorithm>  // std::sort()
+#include <iterator>   // std::make_move_iterator()
+#include <utility>    // std::pair, std::move(), std::forward()
+#include <vector>     // std::vector
+
+#include "dal.h"
+
+/// This class implements a DSAL that absorbs writes in a small unsorted buffer and merges it lazily.
+/*!
+ * New keys are appended to an unsorted delta (as in DAL) and removals of keys
+ * from the sorted array are recorded as tombstones, so a write costs a scan of
+ * the delta instead of an O(n) shift. Writes to a key that is already in the
+ * sorted array (and not removed) go straight to it. The delta is merged into
+ * the sorted array in one linear pass when it reaches `buffer_limit()`
+ * entries, when flush() is called, or before predecessor/successor and the
+ * ordered queries (lower_bound, range, rank, iterators, ...). search
+ * checks the delta first and then binary searches the sorted array; min and
+ * max combine both without merging.
+ *
+ * Invariants: delta keys are not in the sorted array; tombstone keys are.
+ *
+ * The DSAL base is protected, since its members only see the sorted array;
+ * sorted() merges the buffer and hands that array out read-only (e.g. to
+ * FrozenDictionary).
+ *
+ * @tparam KeyType The key type.
+ * @tparam DataType Tha data type to be stored in the dictionary.
+ * @tparam KeyTypeLess A functor/function pointer that compares two keys for strict order <.
+ * @tparam GrowthPolicy Provides `static size_t next(size_t)`, the capacity to grow to when the array is full.
+ * @tparam Layout How entries are laid out in memory: `PairLayout` (interleaved pairs) or `SplitLayout` (separate key and data arrays).
+ */
+template < typename KeyType, typename DataType, typename KeyTypeLess = std::less< KeyType >, typename GrowthPolicy = GrowthFactor<2>, typename Layout = PairLayout >
+class BufferedDSAL : protected DSAL< KeyType, DataType, KeyTypeLess, GrowthPolicy, Layout >
+{
+    private:
+        /// Alias for the parent class.
+        typedef DSAL< KeyType, DataType, KeyTypeLess, GrowthPolicy, Layout > base_type;
+        /// Buffer scans go through the SIMD kernels when keys are of a supported type in their natural order.
+        typedef std::integral_constant< bool, dal_simd::simd_key< KeyType >::find
+                                              and std::is_same< KeyTypeLess, std::less< KeyType > >::value > simd_find;
+
+        static constexpr size_t BUFFER=64; //!< Default buffer limit.
+
+        size_t m_limit;                         //!< The delta is merged once it holds this many entries.
+        std::vector< KeyType > m_delta_keys;    //!< Keys inserted since the last merge, unsorted.
+        std::vector< DataType > m_delta_data;   //!< Their data.
+        std::vector< KeyType > m_tombstones;    //!< Keys of the sorted array removed since the last merge, unsorted.
+
+        /// Returns the index of `_mKey` in `keys`, or keys.size() if it is not there.
+        static size_t scan( const std::vector< KeyType > & keys, const KeyType & _mKey ){
+            return scan( keys, _mKey, simd_find() );
+        }
+        static size_t scan( const std::vector< KeyType > & keys, const KeyType & _mKey, std::true_type ){
+            return dal_simd::find_key( keys.data(), keys.size(), _mKey );
+        }
+        static size_t scan( const std::vector< KeyType > & keys, const KeyType & _mKey, std::false_type ){
+            KeyTypeLess less;
+            size_t i = 0;
+            while ( i < keys.size() and ( less( keys[i], _mKey ) or less( _mKey, keys[i] ) ) ) i++;
+            return i;
+        }
+        /// Removes entry `i` of the delta (order does not matter).
+        void erase_delta( size_t i ){
+            if ( i + 1 != m_delta_keys.size() ) {
+                m_delta_keys[i] = std::move( m_delta_keys.back() );
+                m_delta_data[i] = std::move( m_delta_data.back() );
+            }
+            m_delta_keys.pop_back();
+            m_delta_data.pop_back();
+        }
+        /// Makes sure the next buffered write does not reallocate, so a failed write leaves no trace.
+        void reserve_buffer(){
+            m_delta_keys.reserve( m_limit );
+            m_delta_data.reserve( m_limit );
+            m_tombstones.reserve( m_limit );
+        }
+        /// Merges the buffer if it is full.
+        void check_limit(){
+            if ( m_delta_keys.size() + m_tombstones.size() >= m_limit ) flush();
+        }
+        /// Stores a new key (one that is in neither the sorted array nor the delta).
+        template < typename K, typename... Args >
+        bool insert_new( K && _newKey, Args &&... args ){
+            size_t i = scan( m_tombstones, _newKey );
+            if ( i < m_tombstones.size() ) {
+                // The key is back: write through to the sorted array and drop the tombstone.
+                size_t pos;
+                this->find_index( _newKey, pos );
+                this->m_array.data(pos) = DataType( std::forward< Args >( args )... );
+                m_tombstones[i] = std::move( m_tombstones.back() );
+                m_tombstones.pop_back();
+                DAL_COUNT( inserts, 1 );
+                return true;
+            }
+            DataType data( std::forward< Args >( args )... );
+            m_delta_keys.push_back( std::forward< K >( _newKey ) );
+            m_delta_data.push_back( std::move( data ) );
+            DAL_COUNT( inserts, 1 );
+            check_limit();
+            return true;
+        }
+
+    public:
+        //=== Alias
+        typedef KeyType key_type;   //!< The key type.
+        typedef DataType data_type; //!< The data type.
+
+        //=== special methods
+        /// Default constructor.
+        /*!
+         * @param capacity_ Initial capacity of the sorted array.
+         * @param buffer_limit Writes buffered before a merge; larger values make writes cheaper and lookups dearer.
+         */
+        BufferedDSAL( size_t capacity_ = base_type::SIZE, size_t buffer_limit = BUFFER )
+            : base_type( capacity_ ), m_limit{ buffer_limit ? buffer_limit : 1 }
+        {
+            reserve_buffer();
+        }
+        /// Destructor
+        virtual ~BufferedDSAL() { /* Empty */ };
+        /// Copy constructor; vector copies only keep the size, so the buffer is reserved again.
+        BufferedDSAL ( const BufferedDSAL & other)
+            : base_type( other ), m_limit{ other.m_limit }, m_delta_keys( other.m_delta_keys ),
+              m_delta_data( other.m_delta_data ), m_tombstones( other.m_tombstones )
+        {
+            reserve_buffer();
+        }
+        /// Move constructor
+        BufferedDSAL ( BufferedDSAL && other) = default;
+        /// Copy assignment operator
+        BufferedDSAL & operator= ( const BufferedDSAL & other){
+            if ( this != &other ) {
+                base_type::operator=( other );
+                m_limit = other.m_limit;
+                m_delta_keys = other.m_delta_keys;
+                m_delta_data = other.m_delta_data;
+                m_tombstones = other.m_tombstones;
+                reserve_buffer();
+            }
+            return *this;
+        }
+        /// Move assignment operator
+        BufferedDSAL & operator= ( BufferedDSAL && other) = default;
+
+        //=== status members
+        size_t size (void) const{
+            return this->m_length + m_delta_keys.size() - m_tombstones.size();
+        }
+        bool empty (void) const{
+            return size() == 0;
+        }
+        /// Number of buffered writes that trigger a merge.
+        size_t buffer_limit (void) const{
+            return m_limit;
+        }
+        /// Number of writes currently buffered (new keys plus tombstones).
+        size_t buffered (void) const{
+            return m_delta_keys.size() + m_tombstones.size();
+        }
+        using base_type::capacity;
+        using base_type::reserve;
+        using base_type::shrink_to_fit;
+        using base_type::stats_enabled;
+        using base_type::stats;
+        using base_type::reset_stats;
+
+        //=== bulk modifiers
+        /// Merges the buffered writes into the sorted array, in O(n + k log k) for k buffered writes.
+        void flush (void){
+            if ( not m_tombstones.empty() ) {
+                // Drop removed keys in one compacting pass.
+                KeyTypeLess less;
+                std::sort( m_tombstones.begin(), m_tombstones.end(), less );
+                size_t out = 0, j = 0;
+                for ( size_t i = 0; i < this->m_length; ++i ) {
+                    while ( j < m_tombstones.size() and less( m_tombstones[j], this->m_array.key(i) ) ) ++j;
+                    if ( j < m_tombstones.size() and not less( this->m_array.key(i), m_tombstones[j] ) ) continue;
+                    if ( out != i ) {
+                        this->m_array.move_entry( out, i );
+                        DAL_COUNT( moves, 1 );
+                    }
+                    ++out;
+                }
+                this->m_array.destroy( out, this->m_length );
+                this->m_length = out;
+                m_tombstones.clear();
+            }
+            if ( not m_delta_keys.empty() ) {
+                std::vector< std::pair< KeyType, DataType > > batch;
+                batch.reserve( m_delta_keys.size() );
+                for ( size_t i = 0; i < m_delta_keys.size(); ++i )
+                    batch.emplace_back( std::move( m_delta_keys[i] ), std::move( m_delta_data[i] ) );
+                m_delta_keys.clear();
+                m_delta_data.clear();
+                base_type::insert_range( std::make_move_iterator( batch.begin() ), std::make_move_iterator( batch.end() ) );
+            }
+        }
+        /// Replaces the contents with the (key, data) pairs in [first, last); see DSAL::assign().
+        template < typename InputIt >
+        void assign( InputIt first, InputIt last ){
+            base_type::assign( first, last );
+            m_delta_keys.clear();
+            m_delta_data.clear();
+            m_tombstones.clear();
+        }
+        /// Replaces the contents with the (key, data) pairs in [first, last) on several threads; see DSAL::assign_parallel().
+        template < typename InputIt >
+        void assign_parallel( InputIt first, InputIt last, size_t threads = 0 ){
+            base_type::assign_parallel( first, last, threads );
+            m_delta_keys.clear();
+            m_delta_data.clear();
+            m_tombstones.clear();
+        }
+        /// Inserts the (key, data) pairs in [first, last) with a single merge; see DSAL::insert_range().
+        template < typename InputIt >
+        size_t insert_range( InputIt first, InputIt last ){
+            flush();
+            return base_type::insert_range( first, last );
+        }
+
+        //=== Snapshots
+        /// Merges the buffer, then writes the entries to `path`; see DSAL::save().
+        void save (const std::string & path){
+            flush();
+            base_type::save( path );
+        }
+        using base_type::open_mapped;
+        /// Merges the buffer and returns the sorted array as a read-only DSAL; later writes may be buffered again.
+        const base_type & sorted (void){
+            flush();
+            return *this;
+        }
+
+        //=== acess members
+        bool search (const KeyType & key, DataType & data) const{
+            size_t i = scan( m_delta_keys, key );
+            if ( i < m_delta_keys.size() ) {
+                data = m_delta_data[i];
+                return this->note_lookup( true );
+            }
+            if ( scan( m_tombstones, key ) < m_tombstones.size() ) return this->note_lookup( false );
+            return base_type::search( key, data );
+        }
+        /// Pointer to the data stored under `key`, or nullptr; see DSAL::find().
+        const DataType * find (const KeyType & key) const{
+            size_t i = scan( m_delta_keys, key );
+            if ( i < m_delta_keys.size() ) {
+                this->note_lookup( true );
+                return &m_delta_data[i];
+            }
+            if ( scan( m_tombstones, key ) < m_tombstones.size() ) {
+                this->note_lookup( false );
+                return nullptr;
+            }
+            return base_type::find( key );
+        }
+        DataType * find (const KeyType & key){
+            return const_cast< DataType * >( static_cast< const BufferedDSAL & >( *this ).find( key ) );
+        }
+        /// Whether `key` is stored; the data is not touched.
+        bool contains (const KeyType & key) const{
+            return find( key ) != nullptr;
+        }
+        /// Looks up every key in [first, last); see DSAL::search_many().
+        /*!
+         * With writes still buffered the keys are searched one at a time, since a const
+         * lookup cannot merge the buffer; call flush() first to get the batched search.
+         */
+        template < typename KeyIt, typename OutputIt >
+        size_t search_many( KeyIt first, KeyIt last, OutputIt out ) const{
+            if ( buffered() == 0 ) return base_type::search_many( first, last, out );
+            size_t found = 0;
+            for ( ; first != last; ++first ) {
+                std::pair< bool, DataType > r( false, DataType() );
+                r.first = search( *first, r.second );
+                found += r.first;
+                *out++ = r;
+            }
+            return found;
+        }
+        /// Smallest key, combining the sorted array (skipping removed keys) and the delta; no merge needed.
+        KeyType min (void) const{
+            if ( empty() ) throw std::out_of_range("INVALID");
+            KeyTypeLess less;
+            const KeyType * best = nullptr;
+            for ( size_t i = 0; i < this->m_length and best == nullptr; ++i )
+                if ( scan( m_tombstones, this->m_array.key(i) ) == m_tombstones.size() ) best = &this->m_array.key(i);
+            for ( const KeyType & k : m_delta_keys )
+                if ( best == nullptr or less( k, *best ) ) best = &k;
+            return *best;
+        }
+        /// Largest key, combining the sorted array (skipping removed keys) and the delta; no merge needed.
+        KeyType max (void) const{
+            if ( empty() ) throw std::out_of_range("INVALID");
+            KeyTypeLess less;
+            const KeyType * best = nullptr;
+            for ( size_t i = this->m_length; i > 0 and best == nullptr; --i )
+                if ( scan( m_tombstones, this->m_array.key(i - 1) ) == m_tombstones.size() ) best = &this->m_array.key(i - 1);
+            for ( const KeyType & k : m_delta_keys )
+                if ( best == nullptr or less( *best, k ) ) best = &k;
+            return *best;
+        }
+        /// Merges the buffer, then see DSAL::predecessor().
+        bool predecessor (const KeyType & _mKey, KeyType & _newKey){
+            flush();
+            return base_type::predecessor( _mKey, _newKey );
+        }
+        /// Merges the buffer, then see DSAL::successor().
+        bool successor (const KeyType & _mKey, KeyType & _newKey){
+            flush();
+            return base_type::successor( _mKey, _newKey );
+        }
+        /// Former spelling of successor(), kept for existing callers.
+        bool sucessor (const KeyType & _mKey, KeyType & _newKey){
+            return successor( _mKey, _newKey );
+        }
+
+        //=== Ordered queries and order statistics; each merges the buffer first, see DSAL.
+        typedef typename base_type::const_iterator const_iterator; //!< Iterator over the sorted entries.
+        typedef typename base_type::range_type range_type;         //!< A pair of iterators.
+
+        const_iterator lower_bound (const KeyType & _mKey){
+            flush();
+            return base_type::lower_bound( _mKey );
+        }
+        const_iterator upper_bound (const KeyType & _mKey){
+            flush();
+            return base_type::upper_bound( _mKey );
+        }
+        std::pair< const_iterator, const_iterator > equal_range (const KeyType & _mKey){
+            flush();
+            return base_type::equal_range( _mKey );
+        }
+        range_type range (const KeyType & lo, const KeyType & hi){
+            flush();
+            return base_type::range( lo, hi );
+        }
+        size_t rank (const KeyType & _mKey){
+            flush();
+            return base_type::rank( _mKey );
+        }
+        KeyType select (size_t k){
+            flush();
+            return base_type::select( k );
+        }
+        size_t count_range (const KeyType & lo, const KeyType & hi){
+            flush();
+            return base_type::count_range( lo, hi );
+        }
+        KeyType percentile (double p){
+            flush();
+            return base_type::percentile( p );
+        }
+        const_iterator begin (void){
+            flush();
+            return base_type::begin();
+        }
+        const_iterator end (void){
+            flush();
+            return base_type::end();
+        }
+
+        //=== modifier members.
+        /// Inserts a new entry; if the key already exists its data is overwritten and false is returned.
+        bool insert(const KeyType & _newKey, const DataType & _newInfo){
+            return emplace( _newKey, _newInfo );
+        }
+        /// Inserts a new entry moving key and data in; see insert(const KeyType &, const DataType &).
+        bool insert(KeyType && _newKey, DataType && _newInfo){
+            return emplace( std::move( _newKey ), std::move( _newInfo ) );
+        }
+        /// Inserts `_newKey` with data constructed from `args`; if the key exists its data is replaced and false is returned.
+        template < typename K, typename... Args >
+        bool emplace(K && _newKey, Args &&... args){
+            size_t i = scan( m_delta_keys, _newKey );
+            if ( i < m_delta_keys.size() ) {
+                m_delta_data[i] = DataType( std::forward< Args >( args )... );
+                DAL_COUNT( updates, 1 );
+                return false;
+            }
+            size_t pos;
+            if ( this->find_index( _newKey, pos ) and scan( m_tombstones, _newKey ) == m_tombstones.size() ) {
+                this->m_array.data(pos) = DataType( std::forward< Args >( args )... );
+                DAL_COUNT( updates, 1 );
+                return false;
+            }
+            return insert_new( std::forward< K >( _newKey ), std::forward< Args >( args )... );
+        }
+        /// Like emplace(), but leaves an existing entry untouched (and `args` unused) if the key is already stored.
+        template < typename K, typename... Args >
+        bool try_emplace(K && _newKey, Args &&... args){
+            size_t pos;
+            if ( scan( m_delta_keys, _newKey ) < m_delta_keys.size()
+                 or ( this->find_index( _newKey, pos ) and scan( m_tombstones, _newKey ) == m_tombstones.size() ) ) {
+                DAL_COUNT( updates, 1 );
+                return false;
+            }
+            return insert_new( std::forward< K >( _newKey ), std::forward< Args >( args )... );
+        }
+        /// Removes `_newKey`, moving its data into `_newInfo`; see DAL::extract().
+        /*!
+         * A key of the sorted array is only tombstoned; its data is moved out all the same,
+         * since a tombstoned entry is never read again before the merge drops it.
+         */
+        bool extract(const KeyType & _newKey, DataType & _newInfo){
+            size_t i = scan( m_delta_keys, _newKey );
+            if ( i < m_delta_keys.size() ) {
+                _newInfo = std::move( m_delta_data[i] );
+                erase_delta( i );
+                DAL_COUNT( remove_hits, 1 );
+                return true;
+            }
+            size_t pos;
+            if ( not this->find_index( _newKey, pos ) or scan( m_tombstones, _newKey ) < m_tombstones.size() ) {
+                DAL_COUNT( remove_misses, 1 );
+                return false;
+            }
+            _newInfo = std::move( this->m_array.data(pos) );
+            m_tombstones.push_back( _newKey );
+            DAL_COUNT( remove_hits, 1 );
+            check_limit();
+            return true;
+        }
+        using base_type::remove;
+};
+
+#endif
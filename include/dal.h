@@ -7,78 +7,328 @@
 #include <iostream>   // std::cout, std::endl
 #include <stdexcept>  //
 #include <functional> // std::less<>()
-#include <memory>     // std::unique_ptr
-#include <algorithm>  // std::copy()
-#include <cstring>    // std::memmove()
+#include <algorithm>  // std::stable_sort(), std::max()
 #include <utility>    // std::pair, std::get<>()
 #include <iterator>
+#include <vector>     // std::vector
+#include <thread>     // std::thread
+#include <exception>  // std::exception_ptr
+#include <cmath>      // std::ceil()
+#include <cstdio>     // std::fopen(), std::rename()
+#include <cstring>    // std::memcpy(), std::memset()
+#include <string>     // std::string
+#include <type_traits> // std::is_trivially_copyable
+
+#include "dal_storage.h"
+#include "dal_simd.h"
+#include "dal_snapshot.h"
+#include "dal_stats.h"
+
+/// Growth policy that multiplies the capacity by Num/Den every time the array is full.
+/*!
+ * A larger factor means fewer reallocations at the cost of more unused memory.
+ * @tparam Num Numerator of the growth factor.
+ * @tparam Den Denominator of the growth factor.
+ */
+template < size_t Num, size_t Den = 1 >
+struct GrowthFactor
+{
+    static_assert( Num > Den, "The growth factor must be greater than one." );
+    /// Returns the capacity that follows `capacity`.
+    static size_t next( size_t capacity ){
+        size_t grown = capacity * Num / Den;
+        return grown > capacity ? grown : capacity + 1;
+    }
+};
 
 /// This class implements a dictionary with an UNsorted array of keys.
 /*!
  * @tparam KeyType The key type.
  * @tparam DataType Tha data type to be stored in the dictionary.
  * @tparam KeyTypeLess A functor/function pointer that compares two keys for strict order <.
+ * @tparam GrowthPolicy Provides `static size_t next(size_t)`, the capacity to grow to when the array is full.
+ * @tparam Layout How entries are laid out in memory: `PairLayout` (interleaved pairs) or `SplitLayout` (separate key and data arrays).
  */
-template <typename KeyType , typename DataType, typename KeyTypeLess = std::less<KeyType> >
+template <typename KeyType , typename DataType, typename KeyTypeLess = std::less<KeyType>, typename GrowthPolicy = GrowthFactor<2>, typename Layout = PairLayout >
 class DAL
 {
     protected:
         //=== Alias
         /// Alias that defines a table item.
         typedef std::pair< KeyType, DataType > entry_type;
+        /// Alias for the storage handle that implements the layout.
+        typedef typename Layout::template storage< KeyType, DataType > storage_type;
         enum entry_id_t : size_t { 
         	KEY=0, //!< The key
             DATA=1 //!< The data
         };
 
         static constexpr size_t SIZE=50; //!< Default array size.
+        static constexpr size_t BATCH_SCAN=8; //!< Batches smaller than this are searched one key at a time by search_many().
         size_t m_length;          //!< Array length
         size_t m_capacity;        //!< Current array capacity.
-        std::unique_ptr<entry_type []> m_array; //!< Data storage area for the dynamic array.
+        storage_type m_array;     //!< Handle to the raw storage area; only [0, m_length) holds constructed entries.
+        /// Cached smallest and largest keys, valid while m_extremes_valid is set.
+        /*!
+         * The modifiers keep the cache valid whenever the dictionary is not empty: an
+         * insert updates it in O(1) and removing an extreme rescans at once, so the const
+         * min() and max() only read it and concurrent readers never write. DSAL overrides
+         * min(), max(), predecessor() and successor(), so a sorted array never relies on it.
+         */
+        KeyType m_min;
+        KeyType m_max;
+        bool m_extremes_valid;
+#if DAL_STATS
+        mutable dal_stats::Counters m_stats; //!< Operation counters; see dal_stats.h.
+#endif
+
+        //=== key scans
+        /// Key scans go through the SIMD kernels when the keys are contiguous and of a supported type.
+        typedef std::integral_constant< bool, storage_type::contiguous_keys and dal_simd::simd_key< KeyType >::find > simd_find;
+        /// Ordered scans additionally require the natural order of the keys.
+        typedef std::integral_constant< bool, simd_find::value and dal_simd::simd_key< KeyType >::order
+                                              and std::is_same< KeyTypeLess, std::less< KeyType > >::value > simd_order;
+
+        /// Returns the index of `_mKey` in [0, m_length), or m_length if it is not stored.
+        size_t scan_key( const KeyType & _mKey ) const{
+            size_t i = scan_key( _mKey, simd_find() );
+            DAL_COUNT( comparisons, i < m_length ? i + 1 : m_length );
+            return i;
+        }
+        size_t scan_key( const KeyType & _mKey, std::true_type ) const{
+            return dal_simd::find_key( m_array.keys(), m_length, _mKey );
+        }
+        size_t scan_key( const KeyType & _mKey, std::false_type ) const{
+            size_t i = 0;
+            while ( i < m_length and not ( _mKey == m_array.key(i) ) ) i++;
+            return i;
+        }
+        /// Returns the smallest key of a non-empty dictionary.
+        KeyType scan_min() const{ return scan_min( simd_order() ); }
+        KeyType scan_min( std::true_type ) const{ return dal_simd::min_key( m_array.keys(), m_length ); }
+        KeyType scan_min( std::false_type ) const{
+        	KeyType minor;
+        	minor = m_array.key(0);
+        	KeyTypeLess comp;  
+        	for(size_t i = 0 ; i < m_length;i++){
+        		if(comp(m_array.key(i), minor)){
+        			minor = m_array.key(i);
+        		}
+        	}
+        	return minor;
+        }
+        /// Returns the largest key of a non-empty dictionary.
+        KeyType scan_max() const{ return scan_max( simd_order() ); }
+        KeyType scan_max( std::true_type ) const{ return dal_simd::max_key( m_array.keys(), m_length ); }
+        KeyType scan_max( std::false_type ) const{
+        	KeyType major;
+        	major = m_array.key(0);
+        	KeyTypeLess comp;  
+        	for(size_t i = 0 ; i < m_length;i++){
+        		if(comp(major, m_array.key(i))){
+        			major = m_array.key(i);
+        		}
+        	}
+        	return major;
+        }
+
+        /// Moves the live entries into a new block with room for `capacity` entries.
+        void reallocate( size_t capacity ){
+            m_array.reallocate( m_length, m_capacity, capacity );
+            m_capacity = capacity;
+            DAL_COUNT( resizes, 1 );
+            DAL_COUNT( moves, m_length );
+            DAL_COUNT( bytes_allocated, capacity * storage_type::entry_bytes );
+            DAL_COUNT( bytes_moved, m_length * storage_type::entry_bytes );
+        }
+        /// Counts a lookup that found (`hit`) or missed its key and returns `hit`.
+        bool note_lookup( bool hit ) const{
+            DAL_COUNT( lookup_hits, hit );
+            DAL_COUNT( lookup_misses, not hit );
+            return hit;
+        }
+        /// Refills the min/max cache with one scan per extreme; it is left invalid if the dictionary is empty.
+        void refresh_extremes(){
+            m_extremes_valid = m_length > 0;
+            if ( not m_extremes_valid ) return;
+            m_min = scan_min();
+            m_max = scan_max();
+        }
+        /// Keeps the cache valid after `_newKey` was inserted: O(1).
+        void note_insert( const KeyType & _newKey ){
+            KeyTypeLess less;
+            if ( not m_extremes_valid or less( _newKey, m_min ) ) m_min = _newKey;
+            if ( not m_extremes_valid or less( m_max, _newKey ) ) m_max = _newKey;
+            m_extremes_valid = true;
+        }
+        /// Whether `_oldKey`, about to be removed, is one of the cached extremes; if so refresh the cache after the removal.
+        bool removes_extreme( const KeyType & _oldKey ) const{
+            KeyTypeLess less;
+            return m_extremes_valid and ( not less( m_min, _oldKey ) or not less( _oldKey, m_max ) );
+        }
+        /// Index, among `n` sorted keys, of the `p`-th percentile (nearest rank); throws if p is outside [0, 100].
+        static size_t percentile_index( double p, size_t n ){
+            if ( not ( p >= 0 and p <= 100 ) ) throw std::out_of_range("INVALID");
+            size_t rank = static_cast< size_t >( std::ceil( p / 100 * n ) );
+            return rank == 0 ? 0 : std::min( rank, n ) - 1;
+        }
 
 
     public:
+        //=== Alias
+        typedef KeyType key_type;   //!< The key type.
+        typedef DataType data_type; //!< The data type.
+
         //=== special members.
         /// Default constructor.
-        DAL ( size_t t = SIZE ){
+        DAL ( size_t t = SIZE ) : m_min(), m_max(), m_extremes_valid{ false } {
         	m_length = 0;
         	m_capacity = t;
-        	m_array.reset( new entry_type[t] );
+        	m_array.allocate( t );
+        	DAL_COUNT( bytes_allocated, t * storage_type::entry_bytes );
         }
         /// Destructor
         virtual ~DAL (){
-        	m_array.release();
+            m_array.destroy( 0, m_length );
+            m_array.deallocate( m_capacity );
         }
         /// Copy constructor
-        DAL ( const DAL & other){
-        	m_array.reset(new entry_type[other.m_capacity]);
-        	m_length = other.m_length;
-        	for(size_t i = 0 ; i < other.m_capacity; i++){
-        		m_array[i] = other.m_array[i];
-        	}
+        DAL ( const DAL & other)
+            : m_length{ 0 }, m_capacity{ other.m_capacity },
+              m_min( other.m_min ), m_max( other.m_max ), m_extremes_valid{ other.m_extremes_valid }
+        {
+            m_array.allocate( m_capacity );
+            try {
+                m_array.copy_from( other.m_array, other.m_length );
+            } catch ( ... ) {
+                m_array.deallocate( m_capacity );
+                throw;
+            }
+            m_length = other.m_length;
+            DAL_COUNT( bytes_allocated, m_capacity * storage_type::entry_bytes );
         }
-
+        /// Move constructor. The moved-from dictionary is left empty, with no capacity.
+        DAL ( DAL && other) noexcept
+            : m_length{ other.m_length }, m_capacity{ other.m_capacity }, m_array{ other.m_array },
+              m_min( std::move( other.m_min ) ), m_max( std::move( other.m_max ) ), m_extremes_valid{ other.m_extremes_valid }
+        {
+            other.m_extremes_valid = false;
+            other.m_length = 0;
+            other.m_capacity = 0;
+            other.m_array = storage_type();
+        }
+        /// Copy and move assignment (copy-and-swap).
         DAL & operator= ( DAL other){
-        m_length = other.m_length;
-        m_array.reset(new entry_type[other.m_capacity]);
-        for(size_t i = 0 ; i < other.m_capacity; i++){
-        		m_array[i] = other.m_array[i];
-        	}
+            swap( other );
+            return *this;
+        }
+        /// Exchanges the contents of two dictionaries in O(1).
+        void swap ( DAL & other ) noexcept{
+            std::swap( m_length, other.m_length );
+            std::swap( m_capacity, other.m_capacity );
+            m_array.swap( other.m_array );
+            std::swap( m_min, other.m_min );
+            std::swap( m_max, other.m_max );
+            std::swap( m_extremes_valid, other.m_extremes_valid );
         }
         //=== status members
         size_t 	capacity (void) const {
         	return m_capacity;
         }
+        /// Makes room for at least `n` entries, so the next insertions up to `n` do not reallocate.
+        void reserve ( size_t n ){
+            if ( n > m_capacity ) reallocate( n );
+        }
+        /// Releases the unused capacity.
+        void shrink_to_fit (void){
+            if ( m_capacity > m_length ) reallocate( m_length );
+        }
+        /// Whether this build counts operations (see dal_stats.h).
+        static constexpr bool stats_enabled = DAL_STATS;
+        /// Snapshot of the operation counters; all zero unless built with DAL_STATS.
+        DictionaryStats stats (void) const{
+#if DAL_STATS
+            return m_stats.snapshot();
+#else
+            return DictionaryStats();
+#endif
+        }
+        /// Zeroes the operation counters.
+        void reset_stats (void){
+#if DAL_STATS
+            m_stats.reset();
+#endif
+        }
         //=== acess members
         bool search (const KeyType & key, DataType & data) const{
-        	for(size_t i = 0 ; i < m_length;i++){
-        		if(key == m_array[i].first){
-        			data = m_array[i].second;
-        			return true;
-        		}
+        	size_t i = scan_key(key);
+        	if(note_lookup(i < m_length)){
+        		data = m_array.data(i);
+        		return true;
         	}
         	return false;
         }
+        /// Pointer to the data stored under `key`, or nullptr; nothing is copied. Any insertion or removal invalidates it.
+        const DataType * find (const KeyType & key) const{
+        	size_t i = scan_key(key);
+        	return note_lookup(i < m_length) ? &m_array.data(i) : nullptr;
+        }
+        DataType * find (const KeyType & key){
+        	size_t i = scan_key(key);
+        	return note_lookup(i < m_length) ? &m_array.data(i) : nullptr;
+        }
+        /// Whether `key` is stored; the data is not touched.
+        bool contains (const KeyType & key) const{
+        	return note_lookup(scan_key(key) < m_length);
+        }
+        /// Looks up every key in [first, last) and writes a `std::pair<bool, DataType>` (found, data) per key to `out`.
+        /*!
+         * The batch is sorted once and the array is read in a single pass, each stored key
+         * being looked up among the batch keys, instead of one scan per key. Batches smaller
+         * than BATCH_SCAN are searched one key at a time. In the single pass keys match when
+         * they are equivalent under KeyTypeLess. Missing keys get a default constructed data.
+         * @return The number of keys found.
+         */
+        template < typename KeyIt, typename OutputIt >
+        size_t search_many( KeyIt first, KeyIt last, OutputIt out ) const{
+            std::vector< KeyType > batch( first, last );
+            std::vector< std::pair< bool, DataType > > result( batch.size(), std::make_pair( false, DataType() ) );
+            size_t found = 0;
+            if ( batch.size() < BATCH_SCAN ) {
+                for ( size_t q = 0; q < batch.size(); ++q ) {
+                    result[q].first = search( batch[q], result[q].second );
+                    found += result[q].first;
+                }
+            } else {
+                KeyTypeLess less;
+                std::vector< size_t > order( batch.size() );
+                for ( size_t q = 0; q < order.size(); ++q ) order[q] = q;
+                std::sort( order.begin(), order.end(), [&]( size_t a, size_t b ) { return less( batch[a], batch[b] ); } );
+                std::vector< KeyType > sorted;
+                sorted.reserve( batch.size() );
+                for ( size_t q : order ) sorted.push_back( batch[q] );
+                // Stored keys are unique, so each batch key matches at most once.
+                for ( size_t i = 0; i < m_length and found < batch.size(); ++i ) {
+                    const KeyType & k = m_array.key(i);
+                    // Branchless lower bound of k among the sorted batch keys.
+                    size_t base = 0, count = sorted.size();
+                    while ( count > 1 ) {
+                        size_t half = count / 2;
+                        base = less( sorted[base + half], k ) ? base + half : base;
+                        count -= half;
+                        DAL_COUNT( comparisons, 1 );
+                    }
+                    for ( base += less( sorted[base], k ); base < sorted.size() and not less( k, sorted[base] ); ++base ) {
+                        result[ order[base] ] = std::make_pair( true, m_array.data(i) );
+                        ++found;
+                    }
+                }
+                DAL_COUNT( lookup_hits, found );
+                DAL_COUNT( lookup_misses, batch.size() - found );
+            }
+            std::copy( result.begin(), result.end(), out );
+            return found;
+        }
         bool empty (void) const{
         	if(size() == 0){
         		return true;
@@ -88,283 +338,784 @@ class DAL
        	size_t size (void) const{
         	return m_length;
         }
-      virtual  KeyType min (void) const{
+        /// Smallest key, in O(1) from the cache.
+        virtual KeyType min (void) const{
         	if(empty()){
         		throw std::out_of_range("INVALID");
 
         	}
-        	KeyType minor;
-        	minor = m_array[0].first;
-        	KeyTypeLess comp;  
-        	for(size_t i = 0 ; i < m_length;i++){
-        		if(comp(m_array[i].first, minor)){
-        			minor = m_array[i].first;
-        		}
-        	}
-        	return minor;
+        	return m_min;
         }
-         virtual KeyType max (void) const{
+        /// Largest key, in O(1) from the cache.
+        virtual KeyType max (void) const{
          	if(empty()){
         		throw std::out_of_range("INVALID");
         	
         	}
-        	KeyType major;
-        	major = m_array[0].first;
-        	KeyTypeLess comp;  
-        	for(size_t i = 0 ; i < m_length;i++){
-        		if(comp(major, m_array[i].first)){
-        			major = m_array[i].first;
-        		}
-        	}
-        	return major;
+        	return m_max;
         }
+        /// Largest key less than `_mKey`, which need not be stored, in a single pass.
         virtual bool predecessor (const KeyType & _mKey, KeyType & _newKey){
-        	if(empty() or size() == 1 or min() == _mKey){
+        	KeyTypeLess less;
+        	if(empty() or not less(min(), _mKey)){
         		return false;
         	}
-        	KeyTypeLess pred;
-        	size_t count;
-        	count = 0;
-        	_newKey = min();
-        	while(count < m_length){
-        		if(pred(_newKey, m_array[count].first) and pred(m_array[count].first, _mKey)){
-        			_newKey = m_array[count].first;
+        	const KeyType * best = nullptr;
+        	for(size_t i = 0; i < m_length; i++){
+        		const KeyType & k = m_array.key(i);
+        		if(less(k, _mKey) and (best == nullptr or less(*best, k))){
+        			best = &k;
         		}
-        		count++;
         	}
+        	_newKey = *best;
         	return true;
         }
-         virtual bool successor (const KeyType & _mKey, KeyType & _newKey){
-        	if(empty() or size() == 1 or max() == _mKey){
+        /// Smallest key greater than `_mKey`, which need not be stored, in a single pass.
+        virtual bool successor (const KeyType & _mKey, KeyType & _newKey){
+        	KeyTypeLess less;
+        	if(empty() or not less(_mKey, max())){
         		return false;
         	}
-        	KeyTypeLess suce;
-        	size_t count;
-        	count = 0;
-        	_newKey = max();
-        	while(count < m_length){
-        		if(suce(m_array[count].first, _newKey) and suce(_mKey, m_array[count].first)){
-        			_newKey = m_array[count].first;
+        	const KeyType * best = nullptr;
+        	for(size_t i = 0; i < m_length; i++){
+        		const KeyType & k = m_array.key(i);
+        		if(less(_mKey, k) and (best == nullptr or less(k, *best))){
+        			best = &k;
         		}
-        		count++;
         	}
+        	_newKey = *best;
         	return true;
   		}
+        /// The `k`-th smallest key (from 0), by quickselect on a copy of the keys: O(n) expected, no full sort.
+        KeyType select (size_t k) const{
+            if ( k >= m_length ) throw std::out_of_range("INVALID");
+            std::vector< KeyType > keys;
+            keys.reserve( m_length );
+            for ( size_t i = 0; i < m_length; ++i ) keys.push_back( m_array.key(i) );
+            std::nth_element( keys.begin(), keys.begin() + k, keys.end(), KeyTypeLess() );
+            return keys[k];
+        }
+        /// The `p`-th percentile of the keys, `p` in [0, 100] (nearest rank); see select().
+        KeyType percentile (double p) const{
+            if ( empty() ) throw std::out_of_range("INVALID");
+            return select( percentile_index( p, m_length ) );
+        }
         //=== modifier members.
+        /// Inserts a new entry; if the key already exists its data is overwritten and false is returned.
         virtual bool insert(const KeyType & _newKey, const DataType & _newInfo){
-        	if(m_length == m_capacity){
-        		resize();
-			}
-        	for(size_t i = 0 ; i < m_length ; i++){
-        		if(_newKey == m_array[i].first){
-        			m_array[i].second = _newInfo;
-        			return false;
-        		}
-        	}
-        	m_array[m_length] = {_newKey, _newInfo};
-        	m_length++;
-        	return true;
+            return emplace( _newKey, _newInfo );
         }
-        virtual bool remove(const KeyType & _newKey, DataType & _newInfo){
-        	if(empty())
-        		return false; 
-
-        	for(size_t i = 0 ; i < m_length; i++){
-        		if(_newKey == m_array[i].first){
-        			_newInfo = m_array[i].second;
-        			m_array[i] = m_array[m_length-1];
-        			m_array[m_length] = {KeyType(), DataType()};
-        			m_length--;
-        			return true;
+        /// Inserts a new entry moving key and data in; see insert(const KeyType &, const DataType &).
+        virtual bool insert(KeyType && _newKey, DataType && _newInfo){
+            return emplace( std::move( _newKey ), std::move( _newInfo ) );
+        }
+        /// Inserts `_newKey` with data constructed from `args`; if the key exists its data is replaced and false is returned.
+        template < typename K, typename... Args >
+        bool emplace(K && _newKey, Args &&... args){
+            size_t pos;
+            if(locate(_newKey, pos)){
+                m_array.data(pos) = DataType( std::forward< Args >( args )... );
+                DAL_COUNT( updates, 1 );
+                return false;
+            }
+            // Build the entry before opening its slot: a throwing constructor must not leave a hole in the array.
+            KeyType key( std::forward< K >( _newKey ) );
+            DataType data( std::forward< Args >( args )... );
+            open_slot(pos);
+            m_array.construct( pos, std::move( key ), std::move( data ) );
+            m_length++;
+            note_insert( m_array.key(pos) );
+            DAL_COUNT( inserts, 1 );
+            return true;
+        }
+        /// Like emplace(), but leaves an existing entry untouched (and `args` unused) if the key is already stored.
+        template < typename K, typename... Args >
+        bool try_emplace(K && _newKey, Args &&... args){
+            size_t pos;
+            if(locate(_newKey, pos)){
+                DAL_COUNT( updates, 1 );
+                return false;
+            }
+            KeyType key( std::forward< K >( _newKey ) );
+            DataType data( std::forward< Args >( args )... );
+            open_slot(pos);
+            m_array.construct( pos, std::move( key ), std::move( data ) );
+            m_length++;
+            note_insert( m_array.key(pos) );
+            DAL_COUNT( inserts, 1 );
+            return true;
+        }
+        /// Removes `_newKey`, moving its data into `_newInfo` instead of copying it; false if the key is not stored.
+        virtual bool extract(const KeyType & _newKey, DataType & _newInfo){
+        	size_t i = empty() ? m_length : scan_key(_newKey);
+        	if(i < m_length){
+        		_newInfo = std::move( m_array.data(i) );
+        		bool extreme = removes_extreme(m_array.key(i));
+        		if(i != m_length-1){
+        			m_array.move_entry( i, m_length-1 );
+        			DAL_COUNT( moves, 1 );
         		}
-
+        		m_length--;
+        		m_array.destroy( m_length, m_length+1 );
+        		if(extreme){
+        			refresh_extremes();
+        		}
+        		DAL_COUNT( remove_hits, 1 );
+        		return true;
         	}
+        	DAL_COUNT( remove_misses, 1 );
         	return false;
         }
+        /// Removes `_newKey`, handing its data back in `_newInfo`; see extract().
+        virtual bool remove(const KeyType & _newKey, DataType & _newInfo){
+        	return extract( _newKey, _newInfo );
+        }
+        /// Grows the capacity as dictated by the growth policy, moving the entries into the new array.
         virtual void resize(){
-        	std::unique_ptr<entry_type []> temp;
-        	m_capacity = 2*m_capacity;
-
-			temp.reset( new entry_type[m_capacity]);
-			for(size_t i = 0; i<m_capacity/2;i++){
-				temp[i] = m_array[i];
-			}
-			m_array.reset(new entry_type[m_capacity]);
-			for(size_t i = 0; i<m_capacity/2;i++){
-				m_array[i] = temp[i];
-			}
-			temp.release(); 
+            reallocate( GrowthPolicy::next( m_capacity ) );
+        }
+
+    protected:
+        //=== insertion hooks, shared by insert(), emplace() and try_emplace().
+        /// Returns true if `_mKey` is stored, with its index in `pos`; otherwise `pos` is where it should go.
+        virtual bool locate(const KeyType & _mKey, size_t & pos) const{
+            pos = scan_key(_mKey);
+            return pos < m_length;
+        }
+        /// Makes slot `pos` (as returned by locate()) available for a new entry, growing the array if needed.
+        /*!
+         * On return slot `pos` holds no constructed entry; the caller constructs it in place
+         * from a key and data it has already built, so that nothing can throw in between.
+         */
+        virtual void open_slot(size_t /* pos */){
+            if(m_length == m_capacity){
+                resize();
+            }
         }
 };
 
+template < typename KeyType, typename DataType, typename KeyTypeLess > class FrozenDictionary;
+template < typename KeyType, typename DataType, typename KeyTypeLess > class MappedDictionary;
+
+namespace dal_detail {
+    /// Runs `f(t)` for t in [0, threads), each on its own thread (t = 0 on the caller's), and rethrows the first exception.
+    template < typename F >
+    void run_parallel( size_t threads, F f ){
+        std::vector< std::exception_ptr > errors( threads );
+        std::vector< std::thread > pool;
+        auto task = [&f, &errors]( size_t t ) {
+            try {
+                f( t );
+            } catch ( ... ) {
+                errors[t] = std::current_exception();
+            }
+        };
+        try {
+            for ( size_t t = 1; t < threads; ++t ) pool.emplace_back( task, t );
+        } catch ( ... ) {
+            for ( auto & th : pool ) th.join();
+            throw;
+        }
+        task( 0 );
+        for ( auto & th : pool ) th.join();
+        for ( auto & e : errors )
+            if ( e ) std::rethrow_exception( e );
+    }
+}
+
 /// This class implements a dictionary with a sorted array of keys.
 /*!
  * @tparam KeyType The key type.
  * @tparam DataType Tha data type to be stored in the dictionary.
  * @tparam KeyTypeLess A functor/function pointer that compares two keys for strict order <.
+ * @tparam GrowthPolicy Provides `static size_t next(size_t)`, the capacity to grow to when the array is full.
+ * @tparam Layout How entries are laid out in memory: `PairLayout` (interleaved pairs) or `SplitLayout` (separate key and data arrays).
  */
-template < typename KeyType, typename DataType, typename KeyTypeLess = std::less< KeyType > >
-class DSAL : public DAL< KeyType, DataType, KeyTypeLess >
+template < typename KeyType, typename DataType, typename KeyTypeLess = std::less< KeyType >, typename GrowthPolicy = GrowthFactor<2>, typename Layout = PairLayout >
+class DSAL : public DAL< KeyType, DataType, KeyTypeLess, GrowthPolicy, Layout >
 {
+    /// Reads the sorted entries when freezing a dictionary.
+    template < typename, typename, typename > friend class FrozenDictionary;
+
     private:
+        /// Alias for the parent class.
+        typedef DAL< KeyType, DataType, KeyTypeLess, GrowthPolicy, Layout > base_type;
+        /// Alias that defines a table item.
+        typedef typename base_type::entry_type entry_type;
+        /// Alias for the storage handle that implements the layout.
+        typedef typename base_type::storage_type storage_type;
+
+        /// Returns the index of the first entry whose key is not less than `_mKey` (binary search).
+        size_t lower_bound_index( const KeyType & _mKey ) const{
+            KeyTypeLess less;
+            size_t begin = 0;
+            size_t count = this->m_length;
+            while ( count > 0 ) {
+                size_t half = count / 2;
+                DAL_COUNT( comparisons, 1 );
+                if ( less( this->m_array.key(begin + half), _mKey ) ) {
+                    begin += half + 1;
+                    count -= half + 1;
+                } else {
+                    count = half;
+                }
+            }
+            return begin;
+        }
+        /// Returns the index of the first entry whose key is greater than `_mKey` (binary search).
+        size_t upper_bound_index( const KeyType & _mKey ) const{
+            KeyTypeLess less;
+            size_t begin = 0;
+            size_t count = this->m_length;
+            while ( count > 0 ) {
+                size_t half = count / 2;
+                DAL_COUNT( comparisons, 1 );
+                if ( not less( _mKey, this->m_array.key(begin + half) ) ) {
+                    begin += half + 1;
+                    count -= half + 1;
+                } else {
+                    count = half;
+                }
+            }
+            return begin;
+        }
+    protected:
         /// Returns true and retrive in the second parameter the index of the requested key and returns true; false, otherwise.
-     bool find_index( const KeyType & _mKey, size_t & index) const{	 
-			index = 0;
-			KeyTypeLess test;
-			size_t begin = 0;
-			size_t end = this->m_length -1;
-			while (begin<=end) {
-				index = (begin + end)/2;
-				if (this->m_array[index].first == _mKey){
-					return true;
-				}else {
-					if (test(this->m_array[index].first, _mKey)){
-						begin = index +1;
-					}else{
-						end = index - 1;
-					}
-				}
-			}
-			return false;
-		}
+        /*!
+         * When the key is not found, `index` is the position where it would be inserted.
+         */
+        bool find_index( const KeyType & _mKey, size_t & index) const{
+            KeyTypeLess less;
+            index = lower_bound_index( _mKey );
+            if ( index == this->m_length ) return false;
+            DAL_COUNT( comparisons, 1 );
+            return not less( _mKey, this->m_array.key(index) );
+        }
+        //=== insertion hooks
+        /// Binary search for `_mKey`; on a miss `pos` is the slot that keeps the array sorted.
+        bool locate(const KeyType & _mKey, size_t & pos) const{
+            return find_index( _mKey, pos );
+        }
+        /// Grows the array if needed and moves the tail [pos, length) one slot to the right in a single block.
+        void open_slot(size_t pos){
+            if(this->m_length == this->m_capacity){
+                this->resize();
+            }
+            this->m_array.shift_right( pos, this->m_length );
+            DAL_COUNT( moves, this->m_length - pos );
+        }
+
+    private:
+        static constexpr size_t PARALLEL_GRAIN=1 << 15; //!< Fewest entries per thread for assign_parallel().
+        static constexpr size_t SEARCH_LANES=8;         //!< Binary searches search_many() runs side by side.
+
+        /// Merges part `p` of every sorted chunk of `batch` into `out`, keeping the last occurrence of each key.
+        /*!
+         * Chunks are in input order and stably sorted, so among equal keys the last one merged
+         * (ties go to the earlier chunk first) is the last one in the input.
+         */
+        static void merge_part( std::vector< entry_type > & batch, const std::vector< std::vector< size_t > > & cut,
+                                size_t p, std::vector< entry_type > & out ){
+            KeyTypeLess less;
+            const size_t chunks = cut.size();
+            std::vector< size_t > pos( chunks ), heap;
+            size_t total = 0;
+            for ( size_t c = 0; c < chunks; ++c ) {
+                pos[c] = cut[c][p];
+                total += cut[c][p + 1] - cut[c][p];
+                if ( pos[c] < cut[c][p + 1] ) heap.push_back( c );
+            }
+            // Min-heap of chunks by (next key, chunk index).
+            auto later = [&]( size_t a, size_t b ) {
+                const KeyType & ka = batch[ pos[a] ].first;
+                const KeyType & kb = batch[ pos[b] ].first;
+                if ( less( kb, ka ) ) return true;
+                if ( less( ka, kb ) ) return false;
+                return a > b;
+            };
+            std::make_heap( heap.begin(), heap.end(), later );
+            out.reserve( total );
+            while ( not heap.empty() ) {
+                std::pop_heap( heap.begin(), heap.end(), later );
+                size_t c = heap.back();
+                entry_type & e = batch[ pos[c] ];
+                if ( not out.empty() and not less( out.back().first, e.first ) ) out.back() = std::move( e );
+                else out.push_back( std::move( e ) );
+                if ( ++pos[c] < cut[c][p + 1] ) std::push_heap( heap.begin(), heap.end(), later );
+                else heap.pop_back();
+            }
+        }
+        /// Sorts a batch by key and drops duplicated keys, keeping the last occurrence of each one.
+        static void sort_unique( std::vector< entry_type > & batch ){
+            KeyTypeLess less;
+            std::stable_sort( batch.begin(), batch.end(),
+                    [&less]( const entry_type & a, const entry_type & b ) { return less( a.first, b.first ); } );
+            size_t out = 0;
+            for ( size_t i = 0; i < batch.size(); ++i ) {
+                if ( i + 1 < batch.size() and not less( batch[i].first, batch[i + 1].first ) )
+                    continue; // A later entry has the same key.
+                if ( out != i ) batch[out] = std::move( batch[i] );
+                ++out;
+            }
+            batch.erase( batch.begin() + out, batch.end() );
+        }
 
     public:
+        /// Read-only iterator over the sorted entries; any insertion or removal invalidates it.
+        /*!
+         * Dereferencing yields a pair of references to the key and the data, since the
+         * entries may live in separate arrays (SplitLayout).
+         */
+        class const_iterator {
+            public:
+                typedef std::bidirectional_iterator_tag iterator_category;
+                typedef std::pair< const KeyType &, const DataType & > value_type;
+                typedef value_type reference;
+                typedef std::ptrdiff_t difference_type;
+                typedef void pointer;
+
+                const_iterator() : m_array{ nullptr }, m_index{ 0 } { /* empty */ }
+
+                const KeyType & key (void) const{ return m_array->key( m_index ); }
+                const DataType & data (void) const{ return m_array->data( m_index ); }
+                reference operator* () const{ return reference( key(), data() ); }
+
+                const_iterator & operator++ (){ ++m_index; return *this; }
+                const_iterator operator++ (int){ const_iterator old = *this; ++m_index; return old; }
+                const_iterator & operator-- (){ --m_index; return *this; }
+                const_iterator operator-- (int){ const_iterator old = *this; --m_index; return old; }
+                difference_type operator- (const const_iterator & other) const{
+                    return static_cast< difference_type >( m_index ) - static_cast< difference_type >( other.m_index );
+                }
+                bool operator== (const const_iterator & other) const{ return m_index == other.m_index and m_array == other.m_array; }
+                bool operator!= (const const_iterator & other) const{ return not ( *this == other ); }
+                /// Position of the entry in the sorted array.
+                size_t index (void) const{ return m_index; }
+
+            private:
+                friend class DSAL;
+                const_iterator( const storage_type * array, size_t index ) : m_array{ array }, m_index{ index } { /* empty */ }
+
+                const storage_type * m_array; //!< Storage of the dictionary.
+                size_t m_index;               //!< Current entry.
+        };
+
+        /// A pair of iterators, usable in a range-based for.
+        class range_type {
+            public:
+                range_type( const_iterator first, const_iterator last ) : m_first{ first }, m_last{ last } { /* empty */ }
+                const_iterator begin (void) const{ return m_first; }
+                const_iterator end (void) const{ return m_last; }
+                size_t size (void) const{ return static_cast< size_t >( m_last - m_first ); }
+                bool empty (void) const{ return m_first == m_last; }
+
+            private:
+                const_iterator m_first; //!< First entry of the range.
+                const_iterator m_last;  //!< One past the last entry.
+        };
+
         //=== special methods
         /// Default constructor
-        DSAL( size_t capacity_ = DAL< KeyType, DataType, KeyTypeLess>::SIZE ) : DAL<KeyType, DataType, KeyTypeLess>( capacity_ ) {
+        DSAL( size_t capacity_ = base_type::SIZE ) : base_type( capacity_ ) {
         DSAL::m_capacity = capacity_;
         DSAL::m_length = 0;	
         };
+        /// Range constructor: builds the dictionary from the (key, data) pairs in [first, last).
+        /*!
+         * When a key appears more than once the last occurrence wins.
+         */
+        template < typename InputIt >
+        DSAL( InputIt first, InputIt last ) : base_type( base_type::SIZE ) {
+            assign( first, last );
+        }
         /// Destructor
         virtual ~DSAL() { /* Empty */ };
         /// Copy constructor
-        DSAL ( const DSAL & other){
-        	DSAL::m_capacity = other.m_capacity;
-        	DSAL::m_length = other.m_length;
-        	this = DAL<KeyType, DataType, KeyTypeLess>(other);
-        }
-        DSAL & operator= ( DSAL other){
-        	this->m_length = other.m_length;
-        	this->m_array.reset;
-        	this = DAL<KeyType, DataType, KeyTypeLess>(other);
-        	for(size_t i = 0 ; i < other.m_capacity; i++){
-        		this->m_array[i] = other.m_array[i];
-       		 }
-        }
+        DSAL ( const DSAL & other) = default;
+        /// Move constructor
+        DSAL ( DSAL && other) = default;
+        /// Copy assignment operator
+        DSAL & operator= ( const DSAL & other) = default;
         /// Move assignment operator
+        DSAL & operator= ( DSAL && other) = default;
+
+        //=== Snapshots
+        /// Writes the entries to `path` as a binary snapshot (see dal_snapshot.h); throws std::runtime_error on I/O errors.
+        /*!
+         * Keys and data must be trivially copyable, since they are written as raw bytes.
+         * The file is written next to `path` and renamed over it at the end, so readers
+         * never see a half written snapshot.
+         */
+        void save (const std::string & path) const{
+            static_assert( std::is_trivially_copyable< KeyType >::value and std::is_trivially_copyable< DataType >::value,
+                           "Snapshots store keys and data as raw bytes." );
+            dal_snapshot::Header h;
+            std::memset( &h, 0, sizeof( h ) );
+            std::memcpy( h.magic, dal_snapshot::MAGIC, sizeof( h.magic ) );
+            h.version = dal_snapshot::VERSION;
+            h.byte_order = dal_snapshot::ENDIAN_MARK;
+            h.key_size = sizeof( KeyType );
+            h.data_size = sizeof( DataType );
+            h.count = this->m_length;
+            h.keys_offset = dal_snapshot::align( sizeof( h ) );
+            h.data_offset = dal_snapshot::align( h.keys_offset + h.count * sizeof( KeyType ) );
+            h.file_size = h.data_offset + h.count * sizeof( DataType );
+
+            const std::string temp = path + ".tmp";
+            std::FILE * file = std::fopen( temp.c_str(), "wb" );
+            if ( file == nullptr ) throw std::runtime_error( "DSAL::save: cannot create " + temp );
+            bool ok = true;
+            uint64_t offset = 0;
+            auto write = [&]( const void * bytes, size_t size ) {
+                ok = ok and std::fwrite( bytes, 1, size, file ) == size;
+                offset += size;
+            };
+            const char zeros[dal_snapshot::ALIGNMENT] = {};
+            dal_snapshot::Checksum sum;
+            // Entries go through a buffer, since the pair layout interleaves keys and data.
+            const size_t CHUNK = 4096;
+            std::vector< KeyType > keys;
+            std::vector< DataType > data;
+            write( &h, sizeof( h ) );
+            write( zeros, h.keys_offset - offset );
+            for ( size_t i = 0; i < this->m_length; i += CHUNK ) {
+                keys.clear();
+                for ( size_t j = i; j < std::min( i + CHUNK, this->m_length ); ++j ) keys.push_back( this->m_array.key(j) );
+                sum.update( keys.data(), keys.size() * sizeof( KeyType ) );
+                write( keys.data(), keys.size() * sizeof( KeyType ) );
+            }
+            write( zeros, h.data_offset - offset );
+            for ( size_t i = 0; i < this->m_length; i += CHUNK ) {
+                data.clear();
+                for ( size_t j = i; j < std::min( i + CHUNK, this->m_length ); ++j ) data.push_back( this->m_array.data(j) );
+                sum.update( data.data(), data.size() * sizeof( DataType ) );
+                write( data.data(), data.size() * sizeof( DataType ) );
+            }
+            // The header goes last, once the checksum is known.
+            h.payload_sum = sum.digest();
+            h.header_sum = dal_snapshot::header_checksum( h );
+            ok = ok and std::fseek( file, 0, SEEK_SET ) == 0;
+            write( &h, sizeof( h ) );
+            ok = std::fclose( file ) == 0 and ok;
+            if ( not ok or std::rename( temp.c_str(), path.c_str() ) != 0 ) {
+                std::remove( temp.c_str() );
+                throw std::runtime_error( "DSAL::save: cannot write " + path );
+            }
+        }
+        /// Opens a snapshot written by save() as a read-only MappedDictionary, without reading it in.
+        /*!
+         * Needs `mapped_dictionary.h` (POSIX mmap).
+         */
+        static MappedDictionary< KeyType, DataType, KeyTypeLess > open_mapped (const std::string & path){
+            return MappedDictionary< KeyType, DataType, KeyTypeLess >( path );
+        }
+
+        //=== bulk modifiers
+        /// Replaces the contents with the (key, data) pairs in [first, last), in O(n log n).
+        /*!
+         * When a key appears more than once the last occurrence wins.
+         */
+        template < typename InputIt >
+        void assign( InputIt first, InputIt last ){
+            std::vector< entry_type > batch( first, last );
+            sort_unique( batch );
+            this->m_array.destroy( 0, this->m_length );
+            this->m_length = 0;
+            this->reserve( batch.size() );
+            for ( auto & e : batch ) {
+                this->m_array.construct( this->m_length, std::move( e.first ), std::move( e.second ) );
+                this->m_length++;
+            }
+        }
+        /// Replaces the contents with the (key, data) pairs in [first, last), sorting and merging on several threads.
+        /*!
+         * The input is split in one chunk per thread and every chunk is sorted with KeyTypeLess.
+         * Splitter keys sampled from the sorted chunks then cut the key range in one part per
+         * thread, and each thread merges its part of every chunk (dropping duplicates) and moves
+         * it into its place in the array. Inputs with fewer than PARALLEL_GRAIN entries per
+         * thread use fewer threads, down to the serial assign().
+         * When a key appears more than once the last occurrence wins.
+         * @param threads Worker threads; 0 means std::thread::hardware_concurrency().
+         */
+        template < typename InputIt >
+        void assign_parallel( InputIt first, InputIt last, size_t threads = 0 ){
+            std::vector< entry_type > batch( first, last );
+            if ( threads == 0 ) threads = std::thread::hardware_concurrency();
+            threads = std::min( threads, batch.size() / PARALLEL_GRAIN );
+            if ( threads <= 1 ) {
+                assign( std::make_move_iterator( batch.begin() ), std::make_move_iterator( batch.end() ) );
+                return;
+            }
+            KeyTypeLess less;
+            auto by_key = [&less]( const entry_type & a, const entry_type & b ) { return less( a.first, b.first ); };
+            const size_t n = batch.size();
+
+            // Sort one chunk per thread; chunk c is [bounds[c], bounds[c+1]).
+            std::vector< size_t > bounds( threads + 1 );
+            for ( size_t t = 0; t <= threads; ++t ) bounds[t] = n / threads * t + std::min( t, n % threads );
+            dal_detail::run_parallel( threads, [&]( size_t c ) {
+                std::stable_sort( batch.begin() + bounds[c], batch.begin() + bounds[c + 1], by_key );
+            } );
+
+            // Pick threads-1 splitters among evenly spaced samples of every chunk.
+            std::vector< KeyType > samples;
+            samples.reserve( threads * threads );
+            for ( size_t c = 0; c < threads; ++c )
+                for ( size_t j = 0; j < threads; ++j )
+                    samples.push_back( batch[ bounds[c] + ( bounds[c + 1] - bounds[c] ) * j / threads ].first );
+            std::sort( samples.begin(), samples.end(), less );
+
+            // Part p of chunk c is [cut[c][p], cut[c][p+1]); equal keys always fall in the same part.
+            std::vector< std::vector< size_t > > cut( threads, std::vector< size_t >( threads + 1 ) );
+            for ( size_t c = 0; c < threads; ++c ) {
+                cut[c][0] = bounds[c];
+                cut[c][threads] = bounds[c + 1];
+                for ( size_t p = 1; p < threads; ++p ) {
+                    const KeyType & splitter = samples[ p * samples.size() / threads ];
+                    cut[c][p] = std::lower_bound( batch.begin() + cut[c][p - 1], batch.begin() + bounds[c + 1], splitter,
+                            [&less]( const entry_type & e, const KeyType & k ) { return less( e.first, k ); } ) - batch.begin();
+                }
+            }
+
+            std::vector< std::vector< entry_type > > parts( threads );
+            dal_detail::run_parallel( threads, [&]( size_t p ) { merge_part( batch, cut, p, parts[p] ); } );
+
+            // Move every part into place.
+            std::vector< size_t > offset( threads + 1, 0 );
+            for ( size_t p = 0; p < threads; ++p ) offset[p + 1] = offset[p] + parts[p].size();
+            this->m_array.destroy( 0, this->m_length );
+            this->m_length = 0;
+            this->reserve( offset[threads] );
+            std::vector< size_t > built( threads, 0 );
+            try {
+                dal_detail::run_parallel( threads, [&]( size_t p ) {
+                    for ( auto & e : parts[p] ) {
+                        this->m_array.construct( offset[p] + built[p], std::move( e.first ), std::move( e.second ) );
+                        built[p]++;
+                    }
+                } );
+            } catch ( ... ) {
+                for ( size_t p = 0; p < threads; ++p ) this->m_array.destroy( offset[p], offset[p] + built[p] );
+                throw;
+            }
+            this->m_length = offset[threads];
+        }
+        /// Inserts the (key, data) pairs in [first, last), overwriting the data of existing keys.
+        /*!
+         * The batch is sorted and then merged with the current contents in a single linear pass,
+         * so loading k entries into a dictionary of n costs O(k log k + n) instead of O(k n).
+         * When a key appears more than once in the batch the last occurrence wins.
+         * @return The number of keys that were not in the dictionary before.
+         */
+        template < typename InputIt >
+        size_t insert_range( InputIt first, InputIt last ){
+            std::vector< entry_type > batch( first, last );
+            if ( batch.empty() ) return 0;
+            sort_unique( batch );
+
+            KeyTypeLess less;
+            storage_type & a = this->m_array;
+            size_t capacity = std::max( this->m_capacity, this->m_length + batch.size() );
+            storage_type merged;
+            merged.allocate( capacity );
+            size_t i = 0, j = 0, out = 0, added = 0;
+            try {
+                while ( i < this->m_length and j < batch.size() ) {
+                    if ( less( a.key(i), batch[j].first ) ) {
+                        merged.construct( out++, std::move( a.key(i) ), std::move( a.data(i) ) );
+                        ++i;
+                    } else {
+                        if ( less( batch[j].first, a.key(i) ) ) ++added;
+                        else ++i; // Same key: the batch overwrites the stored entry.
+                        merged.construct( out++, std::move( batch[j].first ), std::move( batch[j].second ) );
+                        ++j;
+                    }
+                }
+                for ( ; i < this->m_length; ++i ) merged.construct( out++, std::move( a.key(i) ), std::move( a.data(i) ) );
+                added += batch.size() - j;
+                for ( ; j < batch.size(); ++j ) merged.construct( out++, std::move( batch[j].first ), std::move( batch[j].second ) );
+            } catch ( ... ) {
+                merged.destroy( 0, out );
+                merged.deallocate( capacity );
+                throw;
+            }
+
+            DAL_COUNT( bytes_allocated, capacity * storage_type::entry_bytes );
+            DAL_COUNT( moves, out - batch.size() );
+            DAL_COUNT( bytes_moved, ( out - batch.size() ) * storage_type::entry_bytes );
+            a.destroy( 0, this->m_length );
+            a.deallocate( this->m_capacity );
+            a = merged;
+            this->m_capacity = capacity;
+            this->m_length = out;
+            return added;
+        }
 
         //=== modifiers overwritten methods.
         bool search (const KeyType & key, DataType & data) const{
    			if(this->empty()){
-   				return false;
+   				return this->note_lookup(false);
    			}
    			size_t search = 0;
-        		if(find_index(key, search)){
-        			data = this->m_array[search].second;
+        		if(this->note_lookup(find_index(key, search))){
+        			data = this->m_array.data(search);
         			return true;
         	}
         	return false;
         }
-        bool remove(const KeyType & _newKey, DataType & _newInfo){
-        	if(this->empty())
-        		return false; 
+        /// Pointer to the data stored under `key`, or nullptr, by binary search; nothing is copied.
+        const DataType * find (const KeyType & key) const{
+        	size_t pos;
+        	return this->note_lookup(find_index(key, pos)) ? &this->m_array.data(pos) : nullptr;
+        }
+        DataType * find (const KeyType & key){
+        	size_t pos;
+        	return this->note_lookup(find_index(key, pos)) ? &this->m_array.data(pos) : nullptr;
+        }
+        /// Whether `key` is stored, by binary search; the data is not touched.
+        bool contains (const KeyType & key) const{
+        	size_t pos;
+        	return this->note_lookup(find_index(key, pos));
+        }
+        /// Looks up every key in [first, last) and writes a `std::pair<bool, DataType>` (found, data) per key to `out`.
+        /*!
+         * Keys are searched in groups of SEARCH_LANES binary searches that advance one level
+         * together, with no data-dependent branch, and each search prefetches its next probe
+         * while the others compare, so the cache misses of the group overlap instead of
+         * being paid one after the other. Missing keys get a default constructed data.
+         * @return The number of keys found.
+         */
+        template < typename KeyIt, typename OutputIt >
+        size_t search_many( KeyIt first, KeyIt last, OutputIt out ) const{
+            KeyTypeLess less;
+            std::vector< KeyType > group;
+            group.reserve( SEARCH_LANES );
+            size_t found = 0;
+            while ( first != last ) {
+                group.clear();
+                for ( ; first != last and group.size() < SEARCH_LANES; ++first ) group.push_back( *first );
+                size_t base[SEARCH_LANES] = {};
+                size_t count = this->m_length;
+                // Branchless lower bound: the window [base, base + count) keeps the answer.
+                while ( count > 1 ) {
+                    size_t half = count / 2;
+                    for ( size_t g = 0; g < group.size(); ++g ) {
+                        base[g] = less( this->m_array.key(base[g] + half), group[g] ) ? base[g] + half : base[g];
+                        __builtin_prefetch( &this->m_array.key(base[g] + ( count - half ) / 2) );
+                    }
+                    count -= half;
+                    DAL_COUNT( comparisons, group.size() );
+                }
+                for ( size_t g = 0; g < group.size(); ++g ) {
+                    size_t i = base[g] + ( count == 1 and less( this->m_array.key(base[g]), group[g] ) );
+                    if ( this->note_lookup( i < this->m_length and not less( group[g], this->m_array.key(i) ) ) ) {
+                        *out++ = std::make_pair( true, this->m_array.data(i) );
+                        ++found;
+                    } else {
+                        *out++ = std::make_pair( false, DataType() );
+                    }
+                }
+            }
+            return found;
+        }
+        /// Removes `_newKey`, moving its data into `_newInfo`; see DAL::extract().
+        bool extract(const KeyType & _newKey, DataType & _newInfo){
         	size_t pos;
 
-       		if(find_index(_newKey, pos)){
-       			_newInfo = this->m_array[pos].second;
-       			for(size_t i = pos; i < this->m_length ; i++){
-       				this->m_array[i] = this->m_array[i + 1];
-       			}
+       		if(not this->empty() and find_index(_newKey, pos)){
+       			_newInfo = std::move( this->m_array.data(pos) );
+       			this->m_array.shift_left( pos, this->m_length );
+       			DAL_COUNT( moves, this->m_length - pos - 1 );
        			this->m_length--;
+       			DAL_COUNT( remove_hits, 1 );
        			return true;
        		}else{
+       			DAL_COUNT( remove_misses, 1 );
         		return false;
        		}
         }
-      bool insert(const KeyType & _newKey, const DataType & _newInfo){
-        	KeyTypeLess teste;
-
-        	if(this->m_length == this->m_capacity){
-        		this->resize();
-			}
-
-			if(this->empty()){
-				this->m_array[0] = {_newKey, _newInfo};
-        		this->m_length++;
-        		return true;
-			}
-
-        	for(size_t i = 0 ; i < this->m_length; ++i){
-        		if(this->m_array[i].first==_newKey){
-         			this->m_array[i].second = _newInfo;
-        			return false;
-        		}
-        	}
-
-        	for(size_t i = 0 ; i < this->m_length; ++i){
-        		if(teste(_newKey, this->m_array[i].first)){
-        			for(size_t j = this->m_length; j > i;j--){
-        				this->m_array[j] = this->m_array[j-1];
-        			}
-        			this->m_array[i] = {_newKey, _newInfo};
-        			this->m_length++;
-        			return true;
-        		}
-
-        	}
-        	this->m_array[this->m_length] = {_newKey, _newInfo};
-        	this->m_length++;
-        	return true;
-        		
-        }
-        		
-
-
-       
         //=== Acessor members
         virtual KeyType max (void) const{
          	if(this->empty()){
         		throw std::out_of_range("INVALID");
         	
         	}
-        	return this->m_array[this->m_length-1].first;
+        	return this->m_array.key(this->m_length-1);
         }
          virtual KeyType min (void) const{
          	if(this->empty()){
         		throw std::out_of_range("INVALID");
         	
         	}
-        	return DSAL::m_array[0].first;
+        	return DSAL::m_array.key(0);
         }
      
         size_t capacity (void) const {
         	return DSAL::m_capacity;
         }
 
+        /// Largest key less than `_mKey`, which need not be stored; binary search, O(log n).
         virtual bool predecessor (const KeyType & _mKey, KeyType & _newKey){
-        	if(this->empty() or this->size() == 1 or this->min() == _mKey){
-        		return false;
-        	}
-   			for(size_t i = 0;i < this->m_length;i++){
-   				if(_mKey == this->m_array[i].first){
-   					_newKey = this->m_array[i-1].first;
-   					return true;
-   				}
-   			}
-        	return false;
+            size_t i = lower_bound_index( _mKey );
+            if ( i == 0 ) return false;
+            _newKey = this->m_array.key(i - 1);
+            return true;
         }
-        virtual bool sucessor (const KeyType & _mKey, KeyType & _newKey){
-        	if(this->empty() or this->size() == 1 or this->max() == _mKey){
-        		return false;
-        	}
-   			for(size_t i = 0;i < this->m_length;i++){
-   				if(_mKey == this->m_array[i].first){
-   					_newKey = this->m_array[i+1].first;
-   					return true;
-   				}
-   			}
-        	return false;
+        /// Smallest key greater than `_mKey`, which need not be stored; binary search, O(log n).
+        virtual bool successor (const KeyType & _mKey, KeyType & _newKey){
+            size_t i = upper_bound_index( _mKey );
+            if ( i == this->m_length ) return false;
+            _newKey = this->m_array.key(i);
+            return true;
+        }
+        /// Former spelling of successor(), kept for existing callers.
+        bool sucessor (const KeyType & _mKey, KeyType & _newKey){
+            return successor( _mKey, _newKey );
         }
+
+        //=== Ordered queries
+        /// Iterator to the first entry whose key is not less than `_mKey`.
+        const_iterator lower_bound (const KeyType & _mKey) const{
+            return const_iterator( &this->m_array, lower_bound_index( _mKey ) );
+        }
+        /// Iterator to the first entry whose key is greater than `_mKey`.
+        const_iterator upper_bound (const KeyType & _mKey) const{
+            return const_iterator( &this->m_array, upper_bound_index( _mKey ) );
+        }
+        /// The entries whose key is equivalent to `_mKey`: empty, or the single entry holding it.
+        std::pair< const_iterator, const_iterator > equal_range (const KeyType & _mKey) const{
+            return std::make_pair( lower_bound( _mKey ), upper_bound( _mKey ) );
+        }
+        /// The entries with keys in the closed interval [lo, hi], in O(log n); empty if hi < lo.
+        range_type range (const KeyType & lo, const KeyType & hi) const{
+            KeyTypeLess less;
+            const_iterator first = lower_bound( lo );
+            if ( less( hi, lo ) ) return range_type( first, first );
+            return range_type( first, upper_bound( hi ) );
+        }
+        //=== Order statistics
+        /// Number of keys less than `_mKey`, which need not be stored; O(log n).
+        size_t rank (const KeyType & _mKey) const{
+            return lower_bound_index( _mKey );
+        }
+        /// The `k`-th smallest key (from 0); O(1).
+        KeyType select (size_t k) const{
+            if ( k >= this->m_length ) throw std::out_of_range("INVALID");
+            return this->m_array.key(k);
+        }
+        /// Number of keys in the closed interval [lo, hi]; O(log n).
+        size_t count_range (const KeyType & lo, const KeyType & hi) const{
+            return range( lo, hi ).size();
+        }
+        /// The `p`-th percentile of the keys, `p` in [0, 100] (nearest rank); O(1).
+        KeyType percentile (double p) const{
+            if ( this->empty() ) throw std::out_of_range("INVALID");
+            return this->m_array.key( base_type::percentile_index( p, this->m_length ) );
+        }
+
+        /// Iterators over all entries, in key order.
+        const_iterator begin (void) const{ return const_iterator( &this->m_array, 0 ); }
+        const_iterator end (void) const{ return const_iterator( &this->m_array, this->m_length ); }
 };
 
 // #include "dal.inl" // This is to get "implementation" from another file.
@@ -0,0 +1,358 @@
+//! SIMD kernels for linear scans over contiguous arithmetic keys.
+
+
+#ifndef _DAL_SIMD_H_
+#define _DAL_SIMD_H_
+
+#include <cstddef>     // size_t
+#include <cstdint>     // int32_t, int64_t
+#include <cstring>     // std::memcpy()
+#include <type_traits> // std::is_integral, std::conditional
+
+#if defined(__GNUC__) and ( defined(__x86_64__) or defined(__i386__) )
+#define DAL_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define DAL_SIMD_X86 0
+#endif
+
+/// Vectorized find/min/max over arrays of 32 and 64-bit integers, floats and doubles.
+/*!
+ * Every kernel has a scalar fallback, and the instruction set is picked at run
+ * time: AVX2 when the CPU has it, SSE2 otherwise (on x86), and plain scalar
+ * code on other architectures.
+ * The kernels mirror the scalar loops in DAL exactly: find() returns the first
+ * index whose key compares equal with `==`, and min()/max() keep the first key
+ * unless a later one is strictly smaller (greater), so NaNs are skipped unless
+ * the first key is a NaN.
+ */
+namespace dal_simd {
+
+    //=== Supported key types
+
+    /// Tells whether `T` can be scanned with the kernels, and which canonical type they use for it.
+    template < typename T >
+    struct simd_key {
+        static constexpr bool is_float = std::is_same< T, float >::value or std::is_same< T, double >::value;
+        static constexpr bool is_int = std::is_integral< T >::value and not std::is_same< T, bool >::value
+                                       and ( sizeof( T ) == 4 or sizeof( T ) == 8 );
+        /// Equality scans work for any bit pattern.
+        static constexpr bool find = is_float or is_int;
+        /// Ordered scans need signed integers or floating point.
+        static constexpr bool order = is_float or ( is_int and std::is_signed< T >::value );
+        /// The type the kernels work on; same size and (for ordered scans) same order as T.
+        typedef typename std::conditional< is_float, T,
+                typename std::conditional< sizeof( T ) == 4, int32_t, int64_t >::type >::type canon;
+    };
+
+    //=== Instruction set selection
+
+    /// Instruction sets the kernels are written for.
+    enum class Isa { scalar, sse2, avx2 };
+
+    /// Returns a printable name for `isa`.
+    inline const char * isa_name( Isa isa ){
+        switch ( isa ) {
+            case Isa::avx2: return "avx2";
+            case Isa::sse2: return "sse2";
+            default:        return "scalar";
+        }
+    }
+    /// The best instruction set this CPU supports.
+    inline Isa best_isa(){
+#if DAL_SIMD_X86
+        static const Isa best = []() -> Isa {
+            __builtin_cpu_init();
+            if ( __builtin_cpu_supports( "avx2" ) ) return Isa::avx2;
+            if ( __builtin_cpu_supports( "sse2" ) ) return Isa::sse2;
+            return Isa::scalar;
+        }();
+        return best;
+#else
+        return Isa::scalar;
+#endif
+    }
+    inline Isa & isa_slot(){
+        static Isa isa = best_isa();
+        return isa;
+    }
+    /// The instruction set the kernels currently dispatch to.
+    inline Isa active_isa(){ return isa_slot(); }
+    /// Restricts the kernels to `isa` (clamped to what the CPU supports); returns the one in effect.
+    /*!
+     * Meant for benchmarks and tests that compare against the scalar path; not thread-safe.
+     */
+    inline Isa use_isa( Isa isa ){
+        if ( static_cast< int >( isa ) > static_cast< int >( best_isa() ) ) isa = best_isa();
+        isa_slot() = isa;
+        return isa;
+    }
+
+    //=== Scalar kernels
+
+    /// Reads the `i`-th element of type T from raw memory (avoids type-punned lvalues).
+    template < typename T >
+    inline T load_scalar( const char * a, size_t i ){
+        T v;
+        std::memcpy( &v, a + i * sizeof( T ), sizeof( T ) );
+        return v;
+    }
+    template < typename T >
+    size_t find_scalar( const char * a, size_t from, size_t n, T key ){
+        for ( size_t i = from; i < n; ++i )
+            if ( load_scalar< T >( a, i ) == key ) return i;
+        return n;
+    }
+    template < typename T >
+    T min_scalar( const char * a, size_t from, size_t n, T best ){
+        for ( size_t i = from; i < n; ++i ) {
+            T v = load_scalar< T >( a, i );
+            if ( v < best ) best = v;
+        }
+        return best;
+    }
+    template < typename T >
+    T max_scalar( const char * a, size_t from, size_t n, T best ){
+        for ( size_t i = from; i < n; ++i ) {
+            T v = load_scalar< T >( a, i );
+            if ( best < v ) best = v;
+        }
+        return best;
+    }
+
+#if DAL_SIMD_X86
+
+#define DAL_SIMD_SSE2 __attribute__(( target( "sse2" ) ))
+#define DAL_SIMD_AVX2 __attribute__(( target( "avx2" ) ))
+
+    //=== Per instruction set and type vector operations.
+    // vmin(x, acc)/vmax(x, acc) return `acc` when x is a NaN, matching the scalar loops.
+
+    struct sse2_i32 {
+        typedef int32_t value_type;
+        typedef __m128i vec;
+        static constexpr size_t width = 4;
+        DAL_SIMD_SSE2 static vec load( const char * p ){ return _mm_loadu_si128( reinterpret_cast< const __m128i * >( p ) ); }
+        DAL_SIMD_SSE2 static void store( value_type * p, vec v ){ _mm_storeu_si128( reinterpret_cast< __m128i * >( p ), v ); }
+        DAL_SIMD_SSE2 static vec set1( value_type v ){ return _mm_set1_epi32( v ); }
+        DAL_SIMD_SSE2 static unsigned eq_mask( vec a, vec b ){ return _mm_movemask_ps( _mm_castsi128_ps( _mm_cmpeq_epi32( a, b ) ) ); }
+        DAL_SIMD_SSE2 static vec vmin( vec x, vec acc ){
+            vec lt = _mm_cmplt_epi32( x, acc );
+            return _mm_or_si128( _mm_and_si128( lt, x ), _mm_andnot_si128( lt, acc ) );
+        }
+        DAL_SIMD_SSE2 static vec vmax( vec x, vec acc ){
+            vec gt = _mm_cmpgt_epi32( x, acc );
+            return _mm_or_si128( _mm_and_si128( gt, x ), _mm_andnot_si128( gt, acc ) );
+        }
+    };
+    /// SSE2 has no 64-bit compares: equality only (ordered scans fall back to scalar code).
+    struct sse2_i64 {
+        typedef int64_t value_type;
+        typedef __m128i vec;
+        static constexpr size_t width = 2;
+        DAL_SIMD_SSE2 static vec load( const char * p ){ return _mm_loadu_si128( reinterpret_cast< const __m128i * >( p ) ); }
+        DAL_SIMD_SSE2 static vec set1( value_type v ){ return _mm_set1_epi64x( v ); }
+        DAL_SIMD_SSE2 static unsigned eq_mask( vec a, vec b ){
+            vec eq = _mm_cmpeq_epi32( a, b );
+            eq = _mm_and_si128( eq, _mm_shuffle_epi32( eq, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+            return _mm_movemask_pd( _mm_castsi128_pd( eq ) );
+        }
+    };
+    struct sse2_f32 {
+        typedef float value_type;
+        typedef __m128 vec;
+        static constexpr size_t width = 4;
+        DAL_SIMD_SSE2 static vec load( const char * p ){ return _mm_loadu_ps( reinterpret_cast< const float * >( p ) ); }
+        DAL_SIMD_SSE2 static void store( value_type * p, vec v ){ _mm_storeu_ps( p, v ); }
+        DAL_SIMD_SSE2 static vec set1( value_type v ){ return _mm_set1_ps( v ); }
+        DAL_SIMD_SSE2 static unsigned eq_mask( vec a, vec b ){ return _mm_movemask_ps( _mm_cmpeq_ps( a, b ) ); }
+        DAL_SIMD_SSE2 static vec vmin( vec x, vec acc ){ return _mm_min_ps( x, acc ); }
+        DAL_SIMD_SSE2 static vec vmax( vec x, vec acc ){ return _mm_max_ps( x, acc ); }
+    };
+    struct sse2_f64 {
+        typedef double value_type;
+        typedef __m128d vec;
+        static constexpr size_t width = 2;
+        DAL_SIMD_SSE2 static vec load( const char * p ){ return _mm_loadu_pd( reinterpret_cast< const double * >( p ) ); }
+        DAL_SIMD_SSE2 static void store( value_type * p, vec v ){ _mm_storeu_pd( p, v ); }
+        DAL_SIMD_SSE2 static vec set1( value_type v ){ return _mm_set1_pd( v ); }
+        DAL_SIMD_SSE2 static unsigned eq_mask( vec a, vec b ){ return _mm_movemask_pd( _mm_cmpeq_pd( a, b ) ); }
+        DAL_SIMD_SSE2 static vec vmin( vec x, vec acc ){ return _mm_min_pd( x, acc ); }
+        DAL_SIMD_SSE2 static vec vmax( vec x, vec acc ){ return _mm_max_pd( x, acc ); }
+    };
+
+    struct avx2_i32 {
+        typedef int32_t value_type;
+        typedef __m256i vec;
+        static constexpr size_t width = 8;
+        DAL_SIMD_AVX2 static vec load( const char * p ){ return _mm256_loadu_si256( reinterpret_cast< const __m256i * >( p ) ); }
+        DAL_SIMD_AVX2 static void store( value_type * p, vec v ){ _mm256_storeu_si256( reinterpret_cast< __m256i * >( p ), v ); }
+        DAL_SIMD_AVX2 static vec set1( value_type v ){ return _mm256_set1_epi32( v ); }
+        DAL_SIMD_AVX2 static unsigned eq_mask( vec a, vec b ){ return _mm256_movemask_ps( _mm256_castsi256_ps( _mm256_cmpeq_epi32( a, b ) ) ); }
+        DAL_SIMD_AVX2 static vec vmin( vec x, vec acc ){ return _mm256_min_epi32( x, acc ); }
+        DAL_SIMD_AVX2 static vec vmax( vec x, vec acc ){ return _mm256_max_epi32( x, acc ); }
+    };
+    struct avx2_i64 {
+        typedef int64_t value_type;
+        typedef __m256i vec;
+        static constexpr size_t width = 4;
+        DAL_SIMD_AVX2 static vec load( const char * p ){ return _mm256_loadu_si256( reinterpret_cast< const __m256i * >( p ) ); }
+        DAL_SIMD_AVX2 static void store( value_type * p, vec v ){ _mm256_storeu_si256( reinterpret_cast< __m256i * >( p ), v ); }
+        DAL_SIMD_AVX2 static vec set1( value_type v ){ return _mm256_set1_epi64x( v ); }
+        DAL_SIMD_AVX2 static unsigned eq_mask( vec a, vec b ){ return _mm256_movemask_pd( _mm256_castsi256_pd( _mm256_cmpeq_epi64( a, b ) ) ); }
+        DAL_SIMD_AVX2 static vec vmin( vec x, vec acc ){ return _mm256_blendv_epi8( acc, x, _mm256_cmpgt_epi64( acc, x ) ); }
+        DAL_SIMD_AVX2 static vec vmax( vec x, vec acc ){ return _mm256_blendv_epi8( acc, x, _mm256_cmpgt_epi64( x, acc ) ); }
+    };
+    struct avx2_f32 {
+        typedef float value_type;
+        typedef __m256 vec;
+        static constexpr size_t width = 8;
+        DAL_SIMD_AVX2 static vec load( const char * p ){ return _mm256_loadu_ps( reinterpret_cast< const float * >( p ) ); }
+        DAL_SIMD_AVX2 static void store( value_type * p, vec v ){ _mm256_storeu_ps( p, v ); }
+        DAL_SIMD_AVX2 static vec set1( value_type v ){ return _mm256_set1_ps( v ); }
+        DAL_SIMD_AVX2 static unsigned eq_mask( vec a, vec b ){ return _mm256_movemask_ps( _mm256_cmp_ps( a, b, _CMP_EQ_OQ ) ); }
+        DAL_SIMD_AVX2 static vec vmin( vec x, vec acc ){ return _mm256_min_ps( x, acc ); }
+        DAL_SIMD_AVX2 static vec vmax( vec x, vec acc ){ return _mm256_max_ps( x, acc ); }
+    };
+    struct avx2_f64 {
+        typedef double value_type;
+        typedef __m256d vec;
+        static constexpr size_t width = 4;
+        DAL_SIMD_AVX2 static vec load( const char * p ){ return _mm256_loadu_pd( reinterpret_cast< const double * >( p ) ); }
+        DAL_SIMD_AVX2 static void store( value_type * p, vec v ){ _mm256_storeu_pd( p, v ); }
+        DAL_SIMD_AVX2 static vec set1( value_type v ){ return _mm256_set1_pd( v ); }
+        DAL_SIMD_AVX2 static unsigned eq_mask( vec a, vec b ){ return _mm256_movemask_pd( _mm256_cmp_pd( a, b, _CMP_EQ_OQ ) ); }
+        DAL_SIMD_AVX2 static vec vmin( vec x, vec acc ){ return _mm256_min_pd( x, acc ); }
+        DAL_SIMD_AVX2 static vec vmax( vec x, vec acc ){ return _mm256_max_pd( x, acc ); }
+    };
+
+    /// Vector operations for each canonical type, per instruction set.
+    template < typename T > struct vec_ops;
+    template <> struct vec_ops< int32_t > { typedef sse2_i32 sse2; typedef avx2_i32 avx2; static constexpr bool sse2_order = true; };
+    template <> struct vec_ops< int64_t > { typedef sse2_i64 sse2; typedef avx2_i64 avx2; static constexpr bool sse2_order = false; };
+    template <> struct vec_ops< float >   { typedef sse2_f32 sse2; typedef avx2_f32 avx2; static constexpr bool sse2_order = true; };
+    template <> struct vec_ops< double >  { typedef sse2_f64 sse2; typedef avx2_f64 avx2; static constexpr bool sse2_order = true; };
+
+    //=== Generic kernels, stamped out once per instruction set (the target attribute cannot be a template argument).
+
+#define DAL_SIMD_DEFINE_KERNELS( SUFFIX, TARGET )                                                    \
+    /* Index of the first element equal to `key`, or n. Four vectors per iteration. */              \
+    template < typename V >                                                                          \
+    TARGET size_t find_##SUFFIX( const char * a, size_t n, typename V::value_type key ){             \
+        typedef typename V::value_type T;                                                            \
+        const size_t w = V::width;                                                                   \
+        const typename V::vec k = V::set1( key );                                                    \
+        size_t i = 0;                                                                                \
+        for ( ; i + 4 * w <= n; i += 4 * w ) {                                                       \
+            unsigned long long m0 = V::eq_mask( V::load( a + i * sizeof( T ) ), k );                 \
+            unsigned long long m1 = V::eq_mask( V::load( a + ( i + w ) * sizeof( T ) ), k );         \
+            unsigned long long m2 = V::eq_mask( V::load( a + ( i + 2 * w ) * sizeof( T ) ), k );     \
+            unsigned long long m3 = V::eq_mask( V::load( a + ( i + 3 * w ) * sizeof( T ) ), k );     \
+            unsigned long long m = m0 | m1 << w | m2 << ( 2 * w ) | m3 << ( 3 * w );                 \
+            if ( m ) return i + __builtin_ctzll( m );                                                \
+        }                                                                                            \
+        for ( ; i + w <= n; i += w ) {                                                               \
+            unsigned m = V::eq_mask( V::load( a + i * sizeof( T ) ), k );                            \
+            if ( m ) return i + __builtin_ctz( m );                                                  \
+        }                                                                                            \
+        return find_scalar< T >( a, i, n, key );                                                     \
+    }                                                                                                \
+    /* Reduces n >= 1 elements with V::vmin/V::vmax (OP), two accumulators to hide latency. */        \
+    template < typename V, bool Min >                                                                \
+    TARGET typename V::value_type extreme_##SUFFIX( const char * a, size_t n ){                      \
+        typedef typename V::value_type T;                                                            \
+        const size_t w = V::width;                                                                   \
+        const T first = load_scalar< T >( a, 0 );                                                    \
+        typename V::vec acc0 = V::set1( first ), acc1 = acc0;                                        \
+        size_t i = 0;                                                                                \
+        for ( ; i + 2 * w <= n; i += 2 * w ) {                                                       \
+            typename V::vec x0 = V::load( a + i * sizeof( T ) );                                     \
+            typename V::vec x1 = V::load( a + ( i + w ) * sizeof( T ) );                             \
+            acc0 = Min ? V::vmin( x0, acc0 ) : V::vmax( x0, acc0 );                                  \
+            acc1 = Min ? V::vmin( x1, acc1 ) : V::vmax( x1, acc1 );                                  \
+        }                                                                                            \
+        T lanes[ 2 * V::width ];                                                                     \
+        V::store( lanes, acc0 );                                                                     \
+        V::store( lanes + w, acc1 );                                                                 \
+        T best = Min ? min_scalar< T >( reinterpret_cast< const char * >( lanes ), 0, 2 * w, first ) \
+                     : max_scalar< T >( reinterpret_cast< const char * >( lanes ), 0, 2 * w, first );\
+        return Min ? min_scalar< T >( a, i, n, best ) : max_scalar< T >( a, i, n, best );            \
+    }
+
+    DAL_SIMD_DEFINE_KERNELS( sse2, DAL_SIMD_SSE2 )
+    DAL_SIMD_DEFINE_KERNELS( avx2, DAL_SIMD_AVX2 )
+
+#undef DAL_SIMD_DEFINE_KERNELS
+
+    template < typename C, bool Min >
+    C extreme_sse2_or_scalar( const char * a, size_t n, std::true_type ){
+        return extreme_sse2< typename vec_ops< C >::sse2, Min >( a, n );
+    }
+    template < typename C, bool Min >
+    C extreme_sse2_or_scalar( const char * a, size_t n, std::false_type ){
+        C first = load_scalar< C >( a, 0 );
+        return Min ? min_scalar< C >( a, 1, n, first ) : max_scalar< C >( a, 1, n, first );
+    }
+
+#endif // DAL_SIMD_X86
+
+    //=== Dispatch on the canonical type.
+
+    template < typename C >
+    size_t find_canon( const char * a, size_t n, C key ){
+#if DAL_SIMD_X86
+        switch ( active_isa() ) {
+            case Isa::avx2: return find_avx2< typename vec_ops< C >::avx2 >( a, n, key );
+            case Isa::sse2: return find_sse2< typename vec_ops< C >::sse2 >( a, n, key );
+            default: break;
+        }
+#endif
+        return find_scalar< C >( a, 0, n, key );
+    }
+    template < typename C, bool Min >
+    C extreme_canon( const char * a, size_t n ){
+#if DAL_SIMD_X86
+        switch ( active_isa() ) {
+            case Isa::avx2: return extreme_avx2< typename vec_ops< C >::avx2, Min >( a, n );
+            case Isa::sse2: return extreme_sse2_or_scalar< C, Min >( a, n, std::integral_constant< bool, vec_ops< C >::sse2_order >() );
+            default: break;
+        }
+#endif
+        C first = load_scalar< C >( a, 0 );
+        return Min ? min_scalar< C >( a, 1, n, first ) : max_scalar< C >( a, 1, n, first );
+    }
+
+    //=== Public interface
+
+    /// Returns the index of the first of the `n` keys equal to `key`, or `n` if there is none.
+    template < typename T >
+    size_t find_key( const T * keys, size_t n, const T & key ){
+        static_assert( simd_key< T >::find, "Key type not supported by the SIMD scan." );
+        typedef typename simd_key< T >::canon C;
+        C k;
+        std::memcpy( &k, &key, sizeof( C ) );
+        return find_canon< C >( reinterpret_cast< const char * >( keys ), n, k );
+    }
+    /// Returns the smallest of the `n` keys (n must be positive).
+    template < typename T >
+    T min_key( const T * keys, size_t n ){
+        static_assert( simd_key< T >::order, "Key type not supported by the SIMD scan." );
+        typedef typename simd_key< T >::canon C;
+        C c = extreme_canon< C, true >( reinterpret_cast< const char * >( keys ), n );
+        T result;
+        std::memcpy( &result, &c, sizeof( T ) );
+        return result;
+    }
+    /// Returns the largest of the `n` keys (n must be positive).
+    template < typename T >
+    T max_key( const T * keys, size_t n ){
+        static_assert( simd_key< T >::order, "Key type not supported by the SIMD scan." );
+        typedef typename simd_key< T >::canon C;
+        C c = extreme_canon< C, false >( reinterpret_cast< const char * >( keys ), n );
+        T result;
+        std::memcpy( &result, &c, sizeof( T ) );
+        return result;
+    }
+}
+
+#endif
@@ -0,0 +1,114 @@
+//! Binary snapshot format shared by DSAL::save() and MappedDictionary.
+
+
+#ifndef _DAL_SNAPSHOT_H_
+#define _DAL_SNAPSHOT_H_
+
+#include <cstddef>    // size_t
+#include <cstdint>    // uint32_t, uint64_t
+#include <cstring>    // std::memcpy(), std::memcmp()
+
+/// Layout of a snapshot file and the checksum that protects it.
+/*!
+ * A snapshot is a fixed-size header followed by the sorted keys and then the
+ * data, each array as raw bytes and starting at a multiple of ALIGNMENT, so a
+ * read-only mapping of the file can be used as two arrays in place:
+ *
+ *     [Header][pad][count keys][pad][count data]
+ *
+ * The header records the sizes of the key and data types and a byte order
+ * marker, so a file is only opened by a program with the same types on the
+ * same kind of machine. `header_sum` covers the header; `payload_sum` covers
+ * both arrays and is only checked on request, since reading the whole file
+ * would defeat opening it in place.
+ */
+namespace dal_snapshot {
+
+    static constexpr char MAGIC[8] = { 'D', 'S', 'A', 'L', 'S', 'N', 'A', 'P' }; //!< First bytes of every snapshot.
+    static constexpr uint32_t VERSION = 1;              //!< Format version written by this code.
+    static constexpr uint32_t ENDIAN_MARK = 0x01020304; //!< Reads back differently on a machine of the other endianness.
+    static constexpr uint64_t ALIGNMENT = 64;           //!< Arrays start at multiples of this offset.
+
+    /// The file header; fixed size, written as raw bytes.
+    struct Header {
+        char magic[8];          //!< MAGIC.
+        uint32_t version;       //!< VERSION.
+        uint32_t byte_order;    //!< ENDIAN_MARK, as written by the saving machine.
+        uint32_t key_size;      //!< sizeof( KeyType ).
+        uint32_t data_size;     //!< sizeof( DataType ).
+        uint64_t count;         //!< Number of entries.
+        uint64_t keys_offset;   //!< Offset of the key array.
+        uint64_t data_offset;   //!< Offset of the data array.
+        uint64_t file_size;     //!< Total size of the file.
+        uint64_t payload_sum;   //!< Checksum of the key array followed by the data array.
+        uint64_t header_sum;    //!< Checksum of the header bytes before this field.
+    };
+
+    /// Rounds `offset` up to the next multiple of ALIGNMENT.
+    inline uint64_t align( uint64_t offset ){
+        return ( offset + ALIGNMENT - 1 ) / ALIGNMENT * ALIGNMENT;
+    }
+
+    /// Streaming 64-bit checksum, 8 bytes per step (not cryptographic; it detects truncation and corruption).
+    class Checksum {
+        public:
+            Checksum() : m_hash{ 0x9E3779B97F4A7C15ULL }, m_length{ 0 }, m_pending{ 0 } { /* empty */ }
+
+            /// Adds `size` bytes; the result does not depend on how the stream is split into calls.
+            void update( const void * bytes, size_t size ){
+                const unsigned char * p = static_cast< const unsigned char * >( bytes );
+                m_length += size;
+                while ( size > 0 and m_pending > 0 ) {
+                    m_tail[m_pending++] = *p++;
+                    --size;
+                    if ( m_pending == 8 ) {
+                        mix( m_tail );
+                        m_pending = 0;
+                    }
+                }
+                for ( ; size >= 8; p += 8, size -= 8 ) mix( p );
+                // Here either nothing is pending or nothing is left, and fewer than 8 bytes remain.
+                for ( size_t i = 0; i < size and m_pending < 8; ++i ) m_tail[m_pending++] = p[i];
+            }
+            /// The checksum of every byte added so far.
+            uint64_t digest() const{
+                unsigned char last[8] = {};
+                std::memcpy( last, m_tail, m_pending );
+                uint64_t word;
+                std::memcpy( &word, last, 8 );
+                uint64_t h = ( m_hash ^ word ^ m_length ) * 0xFF51AFD7ED558CCDULL;
+                h ^= h >> 33;
+                h *= 0xC4CEB9FE1A85EC53ULL;
+                return h ^ ( h >> 33 );
+            }
+
+        private:
+            void mix( const unsigned char * p ){
+                uint64_t word;
+                std::memcpy( &word, p, 8 );
+                m_hash = ( ( m_hash ^ word ) * 0x9FB21C651E98DF25ULL );
+                m_hash ^= m_hash >> 29;
+            }
+
+            uint64_t m_hash;          //!< State after the full words so far.
+            uint64_t m_length;        //!< Bytes added so far.
+            unsigned char m_tail[8];  //!< Bytes of an incomplete word.
+            size_t m_pending;         //!< Number of bytes in m_tail.
+    };
+
+    /// Checksum of the header fields that precede `header_sum`.
+    inline uint64_t header_checksum( const Header & h ){
+        Checksum sum;
+        sum.update( &h, offsetof( Header, header_sum ) );
+        return sum.digest();
+    }
+
+    /// Whether the fixed fields of `h` match this build and types of the given sizes.
+    inline bool compatible( const Header & h, size_t key_size, size_t data_size ){
+        return std::memcmp( h.magic, MAGIC, sizeof( MAGIC ) ) == 0 and h.version == VERSION
+            and h.byte_order == ENDIAN_MARK and h.key_size == key_size and h.data_size == data_size
+            and h.header_sum == header_checksum( h );
+    }
+}
+
+#endif
@@ -0,0 +1,96 @@
+//! Opt-in operation counters for DAL, DSAL and BufferedDSAL.
+
+
+#ifndef _DAL_STATS_H_
+#define _DAL_STATS_H_
+
+#include <cstdint>          // uint64_t
+#include <atomic>           // std::atomic
+#include <initializer_list> // range-for over a braced list
+
+/// Compile with `-DDAL_STATS=1` to count operations; off by default.
+/*!
+ * When off the counting statements expand to nothing and the dictionaries
+ * carry no counter member, so they cost nothing. The switch changes the
+ * layout of the classes: define it the same way in every translation unit
+ * of a program.
+ */
+#ifndef DAL_STATS
+#define DAL_STATS 0
+#endif
+
+/// Counters of the work done by one dictionary since it was built or since reset_stats().
+/*!
+ * Counters belong to the object, not to its contents: a copy or move starts
+ * afresh, counting only its own work from then on, and assignment keeps the
+ * counters of the assigned-to object.
+ */
+struct DictionaryStats {
+    uint64_t comparisons = 0;      //!< Keys compared by lookups (scans and binary searches of the array).
+    uint64_t moves = 0;            //!< Stored entries moved to another slot (shifts, compaction, reallocation).
+    uint64_t resizes = 0;          //!< Reallocations of the array (growth, reserve, shrink_to_fit).
+    uint64_t bytes_allocated = 0;  //!< Bytes of entry storage allocated.
+    uint64_t bytes_moved = 0;      //!< Bytes of entries moved by reallocations and bulk merges.
+    uint64_t lookup_hits = 0;      //!< search/find/contains (and each key of search_many) that found the key.
+    uint64_t lookup_misses = 0;    //!< ... that did not.
+    uint64_t inserts = 0;          //!< insert/emplace/try_emplace calls that added a key.
+    uint64_t updates = 0;          //!< ... that found the key already stored.
+    uint64_t remove_hits = 0;      //!< remove/extract calls that removed a key.
+    uint64_t remove_misses = 0;    //!< ... that did not find it.
+};
+
+namespace dal_stats {
+
+    /// A counter that const lookups may bump while other threads read the same dictionary.
+    /*!
+     * The bump is a relaxed load and store, not an atomic add: it compiles to a
+     * plain increment, and concurrent readers (e.g. under ShardedDictionary's
+     * shared lock) may lose counts but never race.
+     */
+    class Counter {
+        public:
+            Counter() : m_value{ 0 } { /* empty */ }
+            void add( uint64_t n ){ m_value.store( m_value.load( std::memory_order_relaxed ) + n, std::memory_order_relaxed ); }
+            uint64_t get() const{ return m_value.load( std::memory_order_relaxed ); }
+            void reset(){ m_value.store( 0, std::memory_order_relaxed ); }
+
+        private:
+            std::atomic< uint64_t > m_value;
+    };
+
+    /// The live counters behind DictionaryStats; one Counter per field.
+    struct Counters {
+        Counter comparisons, moves, resizes, bytes_allocated, bytes_moved,
+                lookup_hits, lookup_misses, inserts, updates, remove_hits, remove_misses;
+
+        DictionaryStats snapshot() const{
+            DictionaryStats s;
+            s.comparisons = comparisons.get();
+            s.moves = moves.get();
+            s.resizes = resizes.get();
+            s.bytes_allocated = bytes_allocated.get();
+            s.bytes_moved = bytes_moved.get();
+            s.lookup_hits = lookup_hits.get();
+            s.lookup_misses = lookup_misses.get();
+            s.inserts = inserts.get();
+            s.updates = updates.get();
+            s.remove_hits = remove_hits.get();
+            s.remove_misses = remove_misses.get();
+            return s;
+        }
+        void reset(){
+            for ( Counter * c : { &comparisons, &moves, &resizes, &bytes_allocated, &bytes_moved, &lookup_hits,
+                                  &lookup_misses, &inserts, &updates, &remove_hits, &remove_misses } )
+                c->reset();
+        }
+    };
+}
+
+/// Adds `n` to counter `field` of `this->m_stats`; `n` is not evaluated when DAL_STATS is off.
+#if DAL_STATS
+#define DAL_COUNT( field, n ) ( this->m_stats.field.add( static_cast< uint64_t >( n ) ) )
+#else
+#define DAL_COUNT( field, n ) ( (void)0 )
+#endif
+
+#endif
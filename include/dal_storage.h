@@ -0,0 +1,279 @@
+//! Storage layouts for the dictionaries in dal.h.
+
+
+#ifndef _DAL_STORAGE_H_
+#define _DAL_STORAGE_H_
+
+#include <memory>     // std::allocator, std::uninitialized_copy()
+#include <algorithm>  // std::move(), std::move_backward()
+#include <cstring>    // std::memmove()
+#include <utility>    // std::pair, std::forward(), std::swap()
+#include <iterator>   // std::make_move_iterator()
+#include <type_traits> // std::is_trivially_copyable, std::integral_constant
+
+/// Low level helpers to manage arrays of raw (uninitialized) memory.
+namespace dal_detail {
+
+    /// Allocates uninitialized room for `n` objects.
+    template < typename T >
+    T * allocate( size_t n ){
+        return n ? std::allocator< T >().allocate( n ) : nullptr;
+    }
+    /// Releases memory obtained from allocate().
+    template < typename T >
+    void deallocate( T * p, size_t n ){
+        if ( p ) std::allocator< T >().deallocate( p, n );
+    }
+    /// Destroys the objects in [first, last) without releasing their memory.
+    template < typename T >
+    void destroy( T * first, T * last ){
+        for ( ; first != last; ++first ) first->~T();
+    }
+    /// Move-constructs [first, last) into the raw memory at `out`.
+    template < typename T >
+    void uninitialized_move( T * first, T * last, T * out ){
+        std::uninitialized_copy( std::make_move_iterator( first ), std::make_move_iterator( last ), out );
+    }
+
+    /// Whether objects of type `T` can be moved to another slot by copying their bytes.
+    /*!
+     * std::pair is never trivially copyable, since its assignment operators are
+     * user-provided, but a pair of trivially copyable members is relocated like a
+     * plain struct.
+     */
+    template < typename T >
+    struct trivially_relocatable : std::is_trivially_copyable< T > {};
+    template < typename A, typename B >
+    struct trivially_relocatable< std::pair< A, B > >
+        : std::integral_constant< bool, trivially_relocatable< A >::value and trivially_relocatable< B >::value > {};
+
+    /// Opens a hole at `pos` by moving [pos, length) one slot to the right.
+    /*!
+     * Slot `length` must be allocated; on return slot `pos` holds no constructed object.
+     */
+    template < typename T >
+    void shift_right( T * a, size_t pos, size_t length, std::true_type ){
+        std::memmove( static_cast< void * >( a + pos + 1 ), a + pos, ( length - pos ) * sizeof( T ) );
+    }
+    template < typename T >
+    void shift_right( T * a, size_t pos, size_t length, std::false_type ){
+        if ( pos == length ) return;
+        ::new ( static_cast< void * >( a + length ) ) T( std::move( a[length - 1] ) );
+        std::move_backward( a + pos, a + length - 1, a + length );
+        a[pos].~T();
+    }
+    template < typename T >
+    void shift_right( T * a, size_t pos, size_t length ){
+        shift_right( a, pos, length, std::integral_constant< bool, trivially_relocatable< T >::value >() );
+    }
+
+    /// Destroys the object at `pos` and closes the hole by moving (pos, length) one slot to the left.
+    template < typename T >
+    void shift_left( T * a, size_t pos, size_t length, std::true_type ){
+        std::memmove( static_cast< void * >( a + pos ), a + pos + 1, ( length - pos - 1 ) * sizeof( T ) );
+    }
+    template < typename T >
+    void shift_left( T * a, size_t pos, size_t length, std::false_type ){
+        std::move( a + pos + 1, a + length, a + pos );
+        a[length - 1].~T();
+    }
+    template < typename T >
+    void shift_left( T * a, size_t pos, size_t length ){
+        shift_left( a, pos, length, std::integral_constant< bool, trivially_relocatable< T >::value >() );
+    }
+}
+
+/// Interleaved storage: one array of (key, data) pairs.
+/*!
+ * A storage is a non-owning handle to raw memory; the dictionary that holds it
+ * keeps track of length and capacity and decides when to allocate, construct,
+ * destroy and release.
+ */
+template < typename KeyType, typename DataType >
+class PairStorage
+{
+    public:
+        /// Alias that defines a table item.
+        typedef std::pair< KeyType, DataType > entry_type;
+        /// Whether keys are stored contiguously, with no data in between.
+        static constexpr bool contiguous_keys = false;
+        /// Bytes one entry takes in the storage.
+        static constexpr size_t entry_bytes = sizeof( entry_type );
+
+        PairStorage() : m_entries{ nullptr } { /* empty */ }
+
+        //=== memory management
+        void allocate( size_t n ){ m_entries = dal_detail::allocate< entry_type >( n ); }
+        void deallocate( size_t n ){
+            dal_detail::deallocate( m_entries, n );
+            m_entries = nullptr;
+        }
+        /// Moves the first `length` entries into a new block of `capacity` slots and releases the old one.
+        void reallocate( size_t length, size_t old_capacity, size_t capacity ){
+            entry_type * fresh = dal_detail::allocate< entry_type >( capacity );
+            try {
+                dal_detail::uninitialized_move( m_entries, m_entries + length, fresh );
+            } catch ( ... ) {
+                dal_detail::deallocate( fresh, capacity );
+                throw;
+            }
+            dal_detail::destroy( m_entries, m_entries + length );
+            dal_detail::deallocate( m_entries, old_capacity );
+            m_entries = fresh;
+        }
+        /// Copy-constructs the first `length` entries of `other` into this (allocated, empty) storage.
+        void copy_from( const PairStorage & other, size_t length ){
+            std::uninitialized_copy( other.m_entries, other.m_entries + length, m_entries );
+        }
+        void swap( PairStorage & other ) noexcept { std::swap( m_entries, other.m_entries ); }
+
+        //=== element access
+        KeyType & key( size_t i ){ return m_entries[i].first; }
+        const KeyType & key( size_t i ) const { return m_entries[i].first; }
+        DataType & data( size_t i ){ return m_entries[i].second; }
+        const DataType & data( size_t i ) const { return m_entries[i].second; }
+
+        //=== element lifetime
+        /// Constructs the entry at raw slot `i`.
+        template < typename K, typename D >
+        void construct( size_t i, K && key, D && data ){
+            ::new ( static_cast< void * >( m_entries + i ) ) entry_type( std::forward< K >( key ), std::forward< D >( data ) );
+        }
+        /// Destroys the entries in [first, last).
+        void destroy( size_t first, size_t last ){ dal_detail::destroy( m_entries + first, m_entries + last ); }
+        /// Move-assigns the live entry `from` onto the live entry `to`.
+        void move_entry( size_t to, size_t from ){ m_entries[to] = std::move( m_entries[from] ); }
+        void shift_right( size_t pos, size_t length ){ dal_detail::shift_right( m_entries, pos, length ); }
+        void shift_left( size_t pos, size_t length ){ dal_detail::shift_left( m_entries, pos, length ); }
+
+    private:
+        entry_type * m_entries; //!< The (key, data) pairs.
+};
+
+/// Split storage: keys and data in two parallel arrays.
+/*!
+ * Scans over the keys (search, min, max, binary search) touch only the key
+ * array, and the data is only read on a hit. This pays off when the data type
+ * is large compared to the key.
+ */
+template < typename KeyType, typename DataType >
+class SplitStorage
+{
+    public:
+        /// Whether keys are stored contiguously, with no data in between.
+        static constexpr bool contiguous_keys = true;
+        /// Bytes one entry takes in the storage.
+        static constexpr size_t entry_bytes = sizeof( KeyType ) + sizeof( DataType );
+
+        SplitStorage() : m_keys{ nullptr }, m_data{ nullptr } { /* empty */ }
+
+        //=== memory management
+        void allocate( size_t n ){
+            m_keys = dal_detail::allocate< KeyType >( n );
+            try {
+                m_data = dal_detail::allocate< DataType >( n );
+            } catch ( ... ) {
+                dal_detail::deallocate( m_keys, n );
+                m_keys = nullptr;
+                throw;
+            }
+        }
+        void deallocate( size_t n ){
+            dal_detail::deallocate( m_keys, n );
+            dal_detail::deallocate( m_data, n );
+            m_keys = nullptr;
+            m_data = nullptr;
+        }
+        /// Moves the first `length` entries into new blocks of `capacity` slots and releases the old ones.
+        void reallocate( size_t length, size_t old_capacity, size_t capacity ){
+            SplitStorage fresh;
+            fresh.allocate( capacity );
+            try {
+                dal_detail::uninitialized_move( m_keys, m_keys + length, fresh.m_keys );
+            } catch ( ... ) {
+                fresh.deallocate( capacity );
+                throw;
+            }
+            try {
+                dal_detail::uninitialized_move( m_data, m_data + length, fresh.m_data );
+            } catch ( ... ) {
+                dal_detail::destroy( fresh.m_keys, fresh.m_keys + length );
+                fresh.deallocate( capacity );
+                throw;
+            }
+            destroy( 0, length );
+            deallocate( old_capacity );
+            swap( fresh );
+        }
+        /// Copy-constructs the first `length` entries of `other` into this (allocated, empty) storage.
+        void copy_from( const SplitStorage & other, size_t length ){
+            std::uninitialized_copy( other.m_keys, other.m_keys + length, m_keys );
+            try {
+                std::uninitialized_copy( other.m_data, other.m_data + length, m_data );
+            } catch ( ... ) {
+                dal_detail::destroy( m_keys, m_keys + length );
+                throw;
+            }
+        }
+        void swap( SplitStorage & other ) noexcept {
+            std::swap( m_keys, other.m_keys );
+            std::swap( m_data, other.m_data );
+        }
+
+        //=== element access
+        KeyType & key( size_t i ){ return m_keys[i]; }
+        const KeyType & key( size_t i ) const { return m_keys[i]; }
+        DataType & data( size_t i ){ return m_data[i]; }
+        const DataType & data( size_t i ) const { return m_data[i]; }
+        /// The contiguous key array.
+        const KeyType * keys() const { return m_keys; }
+
+        //=== element lifetime
+        /// Constructs the entry at raw slot `i`.
+        template < typename K, typename D >
+        void construct( size_t i, K && key, D && data ){
+            ::new ( static_cast< void * >( m_keys + i ) ) KeyType( std::forward< K >( key ) );
+            try {
+                ::new ( static_cast< void * >( m_data + i ) ) DataType( std::forward< D >( data ) );
+            } catch ( ... ) {
+                m_keys[i].~KeyType();
+                throw;
+            }
+        }
+        /// Destroys the entries in [first, last).
+        void destroy( size_t first, size_t last ){
+            dal_detail::destroy( m_keys + first, m_keys + last );
+            dal_detail::destroy( m_data + first, m_data + last );
+        }
+        /// Move-assigns the live entry `from` onto the live entry `to`.
+        void move_entry( size_t to, size_t from ){
+            m_keys[to] = std::move( m_keys[from] );
+            m_data[to] = std::move( m_data[from] );
+        }
+        void shift_right( size_t pos, size_t length ){
+            dal_detail::shift_right( m_keys, pos, length );
+            dal_detail::shift_right( m_data, pos, length );
+        }
+        void shift_left( size_t pos, size_t length ){
+            dal_detail::shift_left( m_keys, pos, length );
+            dal_detail::shift_left( m_data, pos, length );
+        }
+
+    private:
+        KeyType * m_keys;  //!< The keys.
+        DataType * m_data; //!< The data, parallel to the keys.
+};
+
+/// Layout tag: (key, data) pairs stored interleaved (array of structures). This is the default.
+struct PairLayout {
+    template < typename KeyType, typename DataType >
+    using storage = PairStorage< KeyType, DataType >;
+};
+
+/// Layout tag: keys and data stored in separate arrays (structure of arrays).
+struct SplitLayout {
+    template < typename KeyType, typename DataType >
+    using storage = SplitStorage< KeyType, DataType >;
+};
+
+#endif
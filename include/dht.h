@@ -0,0 +1,301 @@
+//! This class implements a hash Dictionary.
+
+
+#ifndef _DHT_H_
+#define _DHT_H_
+
+#include <stdexcept>  // std::out_of_range
+#include <functional> // std::hash<>, std::equal_to<>, std::less<>
+#include <utility>    // std::move(), std::forward(), std::swap()
+#include <cstdint>    // uint32_t, uint64_t
+#include <cstring>    // std::memset()
+
+#include "dal_storage.h"
+
+/// This class implements a dictionary with an open-addressing hash table (Robin Hood probing).
+/*!
+ * Entries live directly in one array of slots; a parallel array keeps, for every
+ * slot, its distance from the home slot of the entry it holds plus one (0 means
+ * empty). Insertion lets an entry take the slot of a "richer" one (closer to home),
+ * which keeps probe sequences short and lets a search stop as soon as it meets
+ * an entry closer to home than the key would be. Removal shifts the following
+ * entries one slot back instead of leaving tombstones.
+ *
+ * search, insert and remove take O(1) expected time. min, max, predecessor and
+ * successor scan the table in O(n), so DHT can replace DAL and DSAL as is.
+ *
+ * @tparam KeyType The key type.
+ * @tparam DataType Tha data type to be stored in the dictionary.
+ * @tparam Hash A functor that hashes a key into a size_t.
+ * @tparam KeyEqual A functor that compares two keys for equality.
+ * @tparam KeyTypeLess A functor/function pointer that compares two keys for strict order < (ordered operations only).
+ */
+template < typename KeyType, typename DataType, typename Hash = std::hash< KeyType >,
+           typename KeyEqual = std::equal_to< KeyType >, typename KeyTypeLess = std::less< KeyType > >
+class DHT
+{
+    protected:
+        //=== Alias
+        /// Alias that defines a table item.
+        typedef std::pair< KeyType, DataType > entry_type;
+        /// Alias for the type of a probe distance.
+        typedef uint32_t distance_type;
+
+        static constexpr size_t SIZE=50;        //!< Default number of entries that fit without rehashing.
+        static constexpr size_t MIN_SLOTS=8;    //!< Smallest table.
+        static constexpr size_t LOAD_NUM=7;     //!< The table grows when more than LOAD_NUM/LOAD_DEN of the slots are used.
+        static constexpr size_t LOAD_DEN=8;
+
+        size_t m_length;          //!< Number of entries.
+        size_t m_capacity;        //!< Number of slots (a power of two).
+        size_t m_shift;           //!< 64 - log2(m_capacity): hashes are mapped to slots by their top bits.
+        entry_type * m_slots;     //!< The slots; only slots with a non-zero distance hold a constructed entry.
+        distance_type * m_dist;   //!< Probe distance + 1 of the entry in each slot, 0 for an empty slot.
+
+        /// Home slot of `_mKey`. The hash is scrambled first, so identity hashes still spread over the table.
+        size_t home( const KeyType & _mKey ) const{
+            uint64_t h = static_cast< uint64_t >( Hash()( _mKey ) );
+            return static_cast< size_t >( ( h * 0x9E3779B97F4A7C15ULL ) >> m_shift );
+        }
+        size_t next( size_t i ) const{ return ( i + 1 ) & ( m_capacity - 1 ); }
+        /// Most entries the current table holds before it has to grow.
+        size_t limit() const{ return m_capacity / LOAD_DEN * LOAD_NUM; }
+        /// Smallest table that holds `n` entries.
+        static size_t slots_for( size_t n ){
+            size_t slots = MIN_SLOTS;
+            while ( slots / LOAD_DEN * LOAD_NUM < n ) slots *= 2;
+            return slots;
+        }
+
+        /// Returns true if `_mKey` is stored, with its slot in `pos`.
+        bool locate( const KeyType & _mKey, size_t & pos ) const{
+            if ( m_capacity == 0 ) return false; // Moved-from.
+            KeyEqual equal;
+            pos = home( _mKey );
+            for ( distance_type d = 1; m_dist[pos] >= d; ++d ) {
+                if ( m_dist[pos] == d and equal( m_slots[pos].first, _mKey ) ) return true;
+                pos = next( pos );
+            }
+            return false;
+        }
+        /// Places an entry whose key is not stored, displacing richer entries along the way.
+        void place( entry_type && entry ){
+            size_t pos = home( entry.first );
+            distance_type d = 1;
+            while ( m_dist[pos] != 0 ) {
+                if ( m_dist[pos] < d ) {
+                    std::swap( m_slots[pos], entry );
+                    std::swap( m_dist[pos], d );
+                }
+                pos = next( pos );
+                ++d;
+            }
+            ::new ( static_cast< void * >( m_slots + pos ) ) entry_type( std::move( entry ) );
+            m_dist[pos] = d;
+        }
+
+        /// Allocates an empty table of `slots` slots (this must not own any).
+        void allocate( size_t slots ){
+            m_capacity = slots;
+            m_shift = 64;
+            for ( size_t s = slots; s > 1; s /= 2 ) --m_shift;
+            m_slots = dal_detail::allocate< entry_type >( slots );
+            try {
+                m_dist = dal_detail::allocate< distance_type >( slots );
+            } catch ( ... ) {
+                dal_detail::deallocate( m_slots, slots );
+                throw;
+            }
+            if ( slots ) std::memset( m_dist, 0, slots * sizeof( distance_type ) );
+        }
+        /// Destroys every entry and releases the table.
+        void release(){
+            for ( size_t i = 0; i < m_capacity; ++i )
+                if ( m_dist[i] ) m_slots[i].~entry_type();
+            dal_detail::deallocate( m_slots, m_capacity );
+            dal_detail::deallocate( m_dist, m_capacity );
+            m_slots = nullptr;
+            m_dist = nullptr;
+        }
+        /// Moves every entry into a new table of `slots` slots (a power of two, at least MIN_SLOTS).
+        void rehash_to( size_t slots ){
+            DHT fresh( slots / LOAD_DEN * LOAD_NUM );
+            for ( size_t i = 0; i < m_capacity; ++i ) {
+                if ( m_dist[i] ) {
+                    fresh.place( std::move( m_slots[i] ) );
+                    fresh.m_length++;
+                }
+            }
+            swap( fresh );
+        }
+
+        /// Doubles the number of slots.
+        void grow(){ rehash_to( m_capacity ? m_capacity * 2 : size_t( MIN_SLOTS ) ); }
+
+    public:
+        //=== Alias
+        typedef KeyType key_type;   //!< The key type.
+        typedef DataType data_type; //!< The data type.
+
+        //=== special members.
+        /// Default constructor: room for `t` entries before the first rehash.
+        DHT ( size_t t = SIZE ) : m_length{ 0 }, m_slots{ nullptr }, m_dist{ nullptr } {
+            allocate( slots_for( t ) );
+        }
+        /// Destructor
+        virtual ~DHT (){
+            if ( m_slots ) release();
+        }
+        /// Copy constructor; entries keep their slots.
+        DHT ( const DHT & other ) : m_length{ 0 }, m_slots{ nullptr }, m_dist{ nullptr } {
+            allocate( other.m_capacity );
+            try {
+                for ( size_t i = 0; i < m_capacity; ++i ) {
+                    if ( other.m_dist[i] ) {
+                        ::new ( static_cast< void * >( m_slots + i ) ) entry_type( other.m_slots[i] );
+                        m_dist[i] = other.m_dist[i];
+                    }
+                }
+            } catch ( ... ) {
+                release();
+                throw;
+            }
+            m_length = other.m_length;
+        }
+        /// Move constructor. The moved-from dictionary is left empty, with no slots.
+        DHT ( DHT && other ) noexcept
+            : m_length{ other.m_length }, m_capacity{ other.m_capacity }, m_shift{ other.m_shift },
+              m_slots{ other.m_slots }, m_dist{ other.m_dist }
+        {
+            other.m_length = 0;
+            other.m_capacity = 0;
+            other.m_slots = nullptr;
+            other.m_dist = nullptr;
+        }
+        /// Copy and move assignment (copy-and-swap).
+        DHT & operator= ( DHT other ){
+            swap( other );
+            return *this;
+        }
+        /// Exchanges the contents of two dictionaries in O(1).
+        void swap ( DHT & other ) noexcept{
+            std::swap( m_length, other.m_length );
+            std::swap( m_capacity, other.m_capacity );
+            std::swap( m_shift, other.m_shift );
+            std::swap( m_slots, other.m_slots );
+            std::swap( m_dist, other.m_dist );
+        }
+
+        //=== status members
+        /// Number of slots in the table.
+        size_t capacity (void) const { return m_capacity; }
+        size_t size (void) const { return m_length; }
+        bool empty (void) const { return m_length == 0; }
+        /// Makes room for at least `n` entries, so the next insertions up to `n` do not rehash.
+        void reserve ( size_t n ){
+            if ( n > limit() or m_capacity == 0 ) rehash_to( slots_for( n ) );
+        }
+
+        //=== acess members
+        bool search (const KeyType & key, DataType & data) const{
+            size_t pos;
+            if ( m_length == 0 or not locate( key, pos ) ) return false;
+            data = m_slots[pos].second;
+            return true;
+        }
+        KeyType min (void) const{
+            if ( empty() ) throw std::out_of_range("INVALID");
+            KeyTypeLess less;
+            const KeyType * minor = nullptr;
+            for ( size_t i = 0; i < m_capacity; ++i )
+                if ( m_dist[i] and ( minor == nullptr or less( m_slots[i].first, *minor ) ) ) minor = &m_slots[i].first;
+            return *minor;
+        }
+        KeyType max (void) const{
+            if ( empty() ) throw std::out_of_range("INVALID");
+            KeyTypeLess less;
+            const KeyType * major = nullptr;
+            for ( size_t i = 0; i < m_capacity; ++i )
+                if ( m_dist[i] and ( major == nullptr or less( *major, m_slots[i].first ) ) ) major = &m_slots[i].first;
+            return *major;
+        }
+        /// Retrieves the largest key less than `_mKey` (which need not be stored); false if there is none.
+        bool predecessor (const KeyType & _mKey, KeyType & _newKey) const{
+            KeyTypeLess less;
+            const KeyType * best = nullptr;
+            for ( size_t i = 0; i < m_capacity; ++i ) {
+                if ( m_dist[i] == 0 ) continue;
+                const KeyType & k = m_slots[i].first;
+                if ( less( k, _mKey ) and ( best == nullptr or less( *best, k ) ) ) best = &k;
+            }
+            if ( best == nullptr ) return false;
+            _newKey = *best;
+            return true;
+        }
+        /// Retrieves the smallest key greater than `_mKey` (which need not be stored); false if there is none.
+        bool successor (const KeyType & _mKey, KeyType & _newKey) const{
+            KeyTypeLess less;
+            const KeyType * best = nullptr;
+            for ( size_t i = 0; i < m_capacity; ++i ) {
+                if ( m_dist[i] == 0 ) continue;
+                const KeyType & k = m_slots[i].first;
+                if ( less( _mKey, k ) and ( best == nullptr or less( k, *best ) ) ) best = &k;
+            }
+            if ( best == nullptr ) return false;
+            _newKey = *best;
+            return true;
+        }
+
+        //=== modifier members.
+        /// Inserts a new entry; if the key already exists its data is overwritten and false is returned.
+        bool insert(const KeyType & _newKey, const DataType & _newInfo){
+            return emplace( _newKey, _newInfo );
+        }
+        /// Inserts a new entry moving key and data in; see insert(const KeyType &, const DataType &).
+        bool insert(KeyType && _newKey, DataType && _newInfo){
+            return emplace( std::move( _newKey ), std::move( _newInfo ) );
+        }
+        /// Inserts `_newKey` with data constructed from `args`; if the key exists its data is replaced and false is returned.
+        template < typename K, typename... Args >
+        bool emplace(K && _newKey, Args &&... args){
+            size_t pos;
+            if ( locate( _newKey, pos ) ) {
+                m_slots[pos].second = DataType( std::forward< Args >( args )... );
+                return false;
+            }
+            entry_type entry( std::forward< K >( _newKey ), DataType( std::forward< Args >( args )... ) );
+            if ( m_length == limit() ) grow();
+            place( std::move( entry ) );
+            m_length++;
+            return true;
+        }
+        /// Like emplace(), but leaves an existing entry untouched (and `args` unused) if the key is already stored.
+        template < typename K, typename... Args >
+        bool try_emplace(K && _newKey, Args &&... args){
+            size_t pos;
+            if ( locate( _newKey, pos ) ) return false;
+            entry_type entry( std::forward< K >( _newKey ), DataType( std::forward< Args >( args )... ) );
+            if ( m_length == limit() ) grow();
+            place( std::move( entry ) );
+            m_length++;
+            return true;
+        }
+        /// Removes `_newKey`, moving its data into `_newInfo`; the entries after it shift one slot back.
+        bool remove(const KeyType & _newKey, DataType & _newInfo){
+            size_t pos;
+            if ( m_length == 0 or not locate( _newKey, pos ) ) return false;
+            _newInfo = std::move( m_slots[pos].second );
+            m_slots[pos].~entry_type();
+            for ( size_t j = next( pos ); m_dist[j] > 1; j = next( j ) ) {
+                ::new ( static_cast< void * >( m_slots + pos ) ) entry_type( std::move( m_slots[j] ) );
+                m_slots[j].~entry_type();
+                m_dist[pos] = m_dist[j] - 1;
+                pos = j;
+            }
+            m_dist[pos] = 0;
+            m_length--;
+            return true;
+        }
+};
+
+#endif
@@ -0,0 +1,185 @@
+//! Streaming loader that fills a Dictionary from a delimited text file.
+
+
+#ifndef _DICTIONARY_LOADER_H_
+#define _DICTIONARY_LOADER_H_
+
+#include <stdexcept>    // std::runtime_error
+#include <string>       // std::string
+#include <string_view>  // std::string_view
+#include <charconv>     // std::from_chars()
+#include <type_traits>  // std::is_arithmetic, std::void_t
+#include <utility>      // std::pair, std::declval()
+#include <iterator>     // std::move_iterator
+#include <vector>       // std::vector
+#include <algorithm>    // std::max()
+#include <chrono>       // steady_clock
+#include <cstdio>       // std::fopen(), std::fread()
+#include <cstring>      // std::memchr(), std::memmove()
+
+/// Tuning knobs of load_dictionary().
+struct LoadOptions {
+    size_t chunk_bytes = 1 << 20; //!< Bytes read per call; a longer line grows the buffer.
+    size_t batch = 1 << 16;       //!< Fewest rows handed to the dictionary at once.
+    bool skip_header = false;     //!< Ignore the first line.
+};
+
+/// What load_dictionary() read.
+struct LoadStats {
+    size_t rows = 0;      //!< Rows handed to the dictionary.
+    size_t rejected = 0;  //!< Non-empty lines the parser refused.
+    size_t bytes = 0;     //!< Bytes read from the file.
+    double seconds = 0;   //!< Wall time of the whole load.
+
+    double rows_per_second (void) const{ return seconds > 0 ? rows / seconds : 0.0; }
+    double mb_per_second (void) const{ return seconds > 0 ? bytes / seconds / ( 1 << 20 ) : 0.0; }
+};
+
+namespace dal_load {
+
+    /// Parses the whole of `text` as a number with std::from_chars; false on any leftover character.
+    template < typename T >
+    typename std::enable_if< std::is_arithmetic< T >::value, bool >::type
+    parse_field( std::string_view text, T & value ){
+        const char * first = text.data();
+        const char * last = first + text.size();
+        if ( first != last and *first == '+' ) ++first; // from_chars rejects a leading plus.
+        auto result = std::from_chars( first, last, value );
+        return result.ec == std::errc() and result.ptr == last;
+    }
+    /// Copies `text` into `value`, reusing its capacity.
+    inline bool parse_field( std::string_view text, std::string & value ){
+        value.assign( text.data(), text.size() );
+        return true;
+    }
+
+    /// Drops leading and trailing blanks.
+    inline std::string_view trim( std::string_view text ){
+        size_t first = text.find_first_not_of( " \t" );
+        if ( first == std::string_view::npos ) return std::string_view();
+        size_t last = text.find_last_not_of( " \t" );
+        return text.substr( first, last - first + 1 );
+    }
+
+    /// Detects a bulk `insert_range(first, last)` member.
+    template < typename Dict, typename It, typename = void >
+    struct has_insert_range : std::false_type {};
+    template < typename Dict, typename It >
+    struct has_insert_range< Dict, It, std::void_t< decltype( std::declval< Dict & >().insert_range( std::declval< It >(), std::declval< It >() ) ) > >
+        : std::true_type {};
+}
+
+/// Parses `key<separator>data` lines; blanks around each field are ignored.
+/*!
+ * Numbers go through std::from_chars, text is taken as is (no quoting or
+ * escapes). The data is everything after the first separator.
+ */
+template < typename KeyType, typename DataType >
+struct DelimitedParser {
+    char separator = ',';
+
+    bool operator()( std::string_view line, KeyType & key, DataType & data ) const{
+        size_t split = line.find( separator );
+        if ( split == std::string_view::npos ) return false;
+        return dal_load::parse_field( dal_load::trim( line.substr( 0, split ) ), key )
+           and dal_load::parse_field( dal_load::trim( line.substr( split + 1 ) ), data );
+    }
+};
+
+/// Loads the lines of the file at `path` into `dict`; throws std::runtime_error if the file cannot be read.
+/*!
+ * The file is read in large chunks and each line is handed to the parser as a
+ * std::string_view into the chunk, so nothing is allocated per line besides
+ * what the parsed key and data own. `parser(line, key, data)` returns false
+ * to reject a line; empty lines are skipped and a trailing '\r' is removed.
+ *
+ * Parsed rows are collected in batches. A dictionary with `insert_range`
+ * (DSAL) gets each batch in one merge, and a batch is only handed over once
+ * it is at least as large as the dictionary, so the merges add up to
+ * O(n log n). Other dictionaries get one insert() per row. As with insert(),
+ * the last row of a repeated key wins.
+ */
+template < typename Dict, typename Parser >
+LoadStats load_dictionary( const std::string & path, Dict & dict, Parser parser, const LoadOptions & opt = LoadOptions() )
+{
+    typedef typename Dict::key_type key_type;
+    typedef typename Dict::data_type data_type;
+    typedef std::pair< key_type, data_type > entry_type;
+    typedef typename std::vector< entry_type >::iterator move_it;
+    constexpr bool bulk = dal_load::has_insert_range< Dict, std::move_iterator< move_it > >::value;
+
+    auto start = std::chrono::steady_clock::now();
+    std::FILE * file = std::fopen( path.c_str(), "rb" );
+    if ( file == nullptr ) throw std::runtime_error( "load_dictionary: cannot open " + path );
+
+    LoadStats stats;
+    std::vector< entry_type > batch;
+    batch.reserve( std::max< size_t >( opt.batch, 1 ) );
+    auto hand_over = [&]() {
+        if constexpr ( bulk ) {
+            dict.insert_range( std::make_move_iterator( batch.begin() ), std::make_move_iterator( batch.end() ) );
+        } else {
+            for ( auto & e : batch ) dict.insert( std::move( e.first ), std::move( e.second ) );
+        }
+        stats.rows += batch.size();
+        batch.clear();
+    };
+    bool header = opt.skip_header;
+    auto take = [&]( std::string_view line ) {
+        if ( not line.empty() and line.back() == '\r' ) line.remove_suffix( 1 );
+        if ( header ) {
+            header = false;
+            return;
+        }
+        if ( line.empty() ) return;
+        batch.emplace_back();
+        if ( not parser( line, batch.back().first, batch.back().second ) ) {
+            batch.pop_back();
+            ++stats.rejected;
+            return;
+        }
+        size_t due = bulk ? std::max( opt.batch, dict.size() ) : opt.batch;
+        if ( batch.size() >= due ) hand_over();
+    };
+
+    try {
+        std::vector< char > buffer( std::max< size_t >( opt.chunk_bytes, 1 ) );
+        size_t filled = 0;
+        while ( true ) {
+            size_t got = std::fread( buffer.data() + filled, 1, buffer.size() - filled, file );
+            if ( got == 0 and std::ferror( file ) ) throw std::runtime_error( "load_dictionary: cannot read " + path );
+            stats.bytes += got;
+            filled += got;
+            size_t begin = 0;
+            while ( const char * nl = static_cast< const char * >( std::memchr( buffer.data() + begin, '\n', filled - begin ) ) ) {
+                size_t end = nl - buffer.data();
+                take( std::string_view( buffer.data() + begin, end - begin ) );
+                begin = end + 1;
+            }
+            if ( got == 0 ) {
+                if ( begin < filled ) take( std::string_view( buffer.data() + begin, filled - begin ) ); // No final newline.
+                break;
+            }
+            // Keep the partial last line for the next chunk; grow the buffer if one line fills it.
+            std::memmove( buffer.data(), buffer.data() + begin, filled - begin );
+            filled -= begin;
+            if ( filled == buffer.size() ) buffer.resize( 2 * buffer.size() );
+        }
+        if ( not batch.empty() ) hand_over();
+    } catch ( ... ) {
+        std::fclose( file );
+        throw;
+    }
+    std::fclose( file );
+    stats.seconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count();
+    return stats;
+}
+
+/// Loads `key,data` lines with a DelimitedParser; see load_dictionary(const std::string &, Dict &, Parser, const LoadOptions &).
+template < typename Dict >
+LoadStats load_dictionary( const std::string & path, Dict & dict, const LoadOptions & opt = LoadOptions() )
+{
+    return load_dictionary( path, dict, DelimitedParser< typename Dict::key_type, typename Dict::data_type >(), opt );
+}
+
+#endif
@@ -0,0 +1,346 @@
+//! Binary traces of dictionary operations: recording, reading and replaying them.
+
+
+#ifndef _DICTIONARY_TRACE_H_
+#define _DICTIONARY_TRACE_H_
+
+#include <stdexcept>  // std::out_of_range, std::runtime_error
+#include <string>     // std::string
+#include <vector>     // std::vector
+#include <chrono>     // steady_clock
+#include <utility>    // std::move()
+#include <cstdio>     // std::fopen(), std::fread(), std::fwrite()
+#include <cstdint>    // uint8_t, uint32_t, uint64_t
+#include <cstring>    // std::memcpy(), std::memcmp()
+#include <type_traits> // std::is_trivially_copyable
+
+#include "dal_snapshot.h"
+#include "latency_histogram.h"
+
+/// Layout of a trace file.
+/*!
+ * A trace is a fixed header followed by one record per operation, in call order:
+ *
+ *     [Header][op][key][data] [op][key] [op] ...
+ *
+ * Every record is an op byte, then the key as raw bytes (except for MIN and
+ * MAX), then the data as raw bytes (only for INSERT). Keys and data must
+ * therefore be trivially copyable. As with snapshots, the header records the
+ * sizes of both types and a byte order marker, so a trace is only read back
+ * with the same types on the same kind of machine.
+ */
+namespace dal_trace {
+
+    static constexpr char MAGIC[8] = { 'D', 'A', 'L', 'T', 'R', 'A', 'C', 'E' }; //!< First bytes of every trace.
+    static constexpr uint32_t VERSION = 1; //!< Format version written by this code.
+
+    /// The recorded operations.
+    enum op_t : uint8_t {
+        INSERT=0,      //!< insert(key, data).
+        SEARCH=1,      //!< search(key, data).
+        REMOVE=2,      //!< remove(key, data).
+        MIN=3,         //!< min().
+        MAX=4,         //!< max().
+        PREDECESSOR=5, //!< predecessor(key, out).
+        SUCCESSOR=6,   //!< successor(key, out).
+        OPS=7          //!< Number of operations.
+    };
+
+    /// Name of `op`, for reports.
+    inline const char * op_name( size_t op ){
+        static const char * const names[OPS] = { "insert", "search", "remove", "min", "max", "predecessor", "successor" };
+        return op < OPS ? names[op] : "unknown";
+    }
+
+    /// The file header; fixed size, written as raw bytes.
+    struct Header {
+        char magic[8];          //!< MAGIC.
+        uint32_t version;       //!< VERSION.
+        uint32_t byte_order;    //!< dal_snapshot::ENDIAN_MARK, as written by the recording machine.
+        uint32_t key_size;      //!< sizeof( KeyType ).
+        uint32_t data_size;     //!< sizeof( DataType ).
+    };
+
+    /// One recorded operation; `key` is unused for MIN and MAX, `data` is only used for INSERT.
+    template < typename KeyType, typename DataType >
+    struct Event {
+        op_t op;
+        KeyType key;
+        DataType data;
+    };
+}
+
+/// This class implements a writer of trace files; see dal_trace.
+/*!
+ * Records go through a buffer and reach the file in large writes. close()
+ * reports I/O errors; the destructor closes a writer that is still open
+ * and ignores them.
+ */
+template < typename KeyType, typename DataType >
+class TraceWriter
+{
+    static_assert( std::is_trivially_copyable< KeyType >::value and std::is_trivially_copyable< DataType >::value,
+                   "Traces store keys and data as raw bytes." );
+
+    private:
+        static constexpr size_t BUFFER = 1 << 16; //!< Bytes buffered before a write.
+
+        std::FILE * m_file;          //!< The trace, or nullptr once closed.
+        std::vector< char > m_buffer; //!< Records not written yet.
+        bool m_ok;                   //!< False after a failed write.
+        uint64_t m_events;           //!< Records written so far.
+
+        void put( const void * bytes, size_t size ){
+            const char * p = static_cast< const char * >( bytes );
+            m_buffer.insert( m_buffer.end(), p, p + size );
+        }
+        void drain(){
+            if ( not m_buffer.empty() ) m_ok = m_ok and std::fwrite( m_buffer.data(), 1, m_buffer.size(), m_file ) == m_buffer.size();
+            m_buffer.clear();
+        }
+        void event( dal_trace::op_t op, const KeyType * key, const DataType * data ){
+            if ( m_file == nullptr ) throw std::runtime_error( "TraceWriter: trace already closed" );
+            uint8_t code = op;
+            put( &code, 1 );
+            if ( key != nullptr ) put( key, sizeof( KeyType ) );
+            if ( data != nullptr ) put( data, sizeof( DataType ) );
+            m_events++;
+            if ( m_buffer.size() >= BUFFER ) drain();
+        }
+
+    public:
+        //=== special members.
+        /// Creates (or truncates) the trace at `path`; throws std::runtime_error if it cannot be created.
+        explicit TraceWriter( const std::string & path ) : m_file{ std::fopen( path.c_str(), "wb" ) }, m_ok{ true }, m_events{ 0 } {
+            if ( m_file == nullptr ) throw std::runtime_error( "TraceWriter: cannot create " + path );
+            m_buffer.reserve( BUFFER + sizeof( KeyType ) + sizeof( DataType ) + 1 );
+            dal_trace::Header h;
+            std::memset( &h, 0, sizeof( h ) );
+            std::memcpy( h.magic, dal_trace::MAGIC, sizeof( h.magic ) );
+            h.version = dal_trace::VERSION;
+            h.byte_order = dal_snapshot::ENDIAN_MARK;
+            h.key_size = sizeof( KeyType );
+            h.data_size = sizeof( DataType );
+            put( &h, sizeof( h ) );
+        }
+        /// Destructor; closes the trace if still open, ignoring errors.
+        ~TraceWriter(){
+            if ( m_file != nullptr ) {
+                drain();
+                std::fclose( m_file );
+            }
+        }
+        TraceWriter( const TraceWriter & ) = delete;
+        TraceWriter & operator= ( const TraceWriter & ) = delete;
+
+        /// Writes the buffered records and closes the file; throws std::runtime_error if any write failed.
+        void close(){
+            if ( m_file == nullptr ) return;
+            drain();
+            bool ok = std::fclose( m_file ) == 0 and m_ok;
+            m_file = nullptr;
+            if ( not ok ) throw std::runtime_error( "TraceWriter: cannot write the trace" );
+        }
+        /// Records written so far.
+        uint64_t events (void) const{ return m_events; }
+
+        //=== records
+        void insert( const KeyType & key, const DataType & data ){ event( dal_trace::INSERT, &key, &data ); }
+        void search( const KeyType & key ){ event( dal_trace::SEARCH, &key, nullptr ); }
+        void remove( const KeyType & key ){ event( dal_trace::REMOVE, &key, nullptr ); }
+        void min(){ event( dal_trace::MIN, nullptr, nullptr ); }
+        void max(){ event( dal_trace::MAX, nullptr, nullptr ); }
+        void predecessor( const KeyType & key ){ event( dal_trace::PREDECESSOR, &key, nullptr ); }
+        void successor( const KeyType & key ){ event( dal_trace::SUCCESSOR, &key, nullptr ); }
+};
+
+/// Reads a whole trace written by TraceWriter; throws std::runtime_error if it cannot be read, was recorded with other types or is truncated.
+template < typename KeyType, typename DataType >
+std::vector< dal_trace::Event< KeyType, DataType > > read_trace( const std::string & path )
+{
+    static_assert( std::is_trivially_copyable< KeyType >::value and std::is_trivially_copyable< DataType >::value,
+                   "Traces store keys and data as raw bytes." );
+    std::FILE * file = std::fopen( path.c_str(), "rb" );
+    if ( file == nullptr ) throw std::runtime_error( "read_trace: cannot open " + path );
+    std::vector< char > bytes;
+    char chunk[1 << 16];
+    size_t got;
+    while ( ( got = std::fread( chunk, 1, sizeof( chunk ), file ) ) > 0 ) bytes.insert( bytes.end(), chunk, chunk + got );
+    bool failed = std::ferror( file ) != 0;
+    std::fclose( file );
+    if ( failed ) throw std::runtime_error( "read_trace: cannot read " + path );
+
+    dal_trace::Header h;
+    if ( bytes.size() < sizeof( h ) ) throw std::runtime_error( "read_trace: not a trace: " + path );
+    std::memcpy( &h, bytes.data(), sizeof( h ) );
+    if ( std::memcmp( h.magic, dal_trace::MAGIC, sizeof( h.magic ) ) != 0 or h.version != dal_trace::VERSION
+         or h.byte_order != dal_snapshot::ENDIAN_MARK or h.key_size != sizeof( KeyType ) or h.data_size != sizeof( DataType ) )
+        throw std::runtime_error( "read_trace: not a trace of this key/data type: " + path );
+
+    std::vector< dal_trace::Event< KeyType, DataType > > events;
+    size_t at = sizeof( h );
+    while ( at < bytes.size() ) {
+        dal_trace::Event< KeyType, DataType > e = dal_trace::Event< KeyType, DataType >();
+        uint8_t code = static_cast< uint8_t >( bytes[at++] );
+        if ( code >= dal_trace::OPS ) throw std::runtime_error( "read_trace: bad record in " + path );
+        e.op = static_cast< dal_trace::op_t >( code );
+        size_t need = ( e.op == dal_trace::MIN or e.op == dal_trace::MAX ? 0 : sizeof( KeyType ) )
+                    + ( e.op == dal_trace::INSERT ? sizeof( DataType ) : 0 );
+        if ( bytes.size() - at < need ) throw std::runtime_error( "read_trace: truncated trace " + path );
+        if ( e.op != dal_trace::MIN and e.op != dal_trace::MAX ) {
+            std::memcpy( &e.key, bytes.data() + at, sizeof( KeyType ) );
+            at += sizeof( KeyType );
+        }
+        if ( e.op == dal_trace::INSERT ) {
+            std::memcpy( &e.data, bytes.data() + at, sizeof( DataType ) );
+            at += sizeof( DataType );
+        }
+        events.push_back( e );
+    }
+    return events;
+}
+
+/// This class implements a Dictionary wrapper that records every call into a trace.
+/*!
+ * The calls are forwarded to the wrapped dictionary and appended to a
+ * TraceWriter, so a production workload can be replayed offline with
+ * replay_trace() (or the replay_dictionary tool) against other implementations.
+ *
+ * @tparam Dict The dictionary type; its keys and data must be trivially copyable.
+ */
+template < typename Dict >
+class RecordingDictionary
+{
+    public:
+        //=== Alias
+        typedef typename Dict::key_type key_type;   //!< The key type.
+        typedef typename Dict::data_type data_type; //!< The data type.
+
+    private:
+        Dict m_dict;                                  //!< The recorded dictionary.
+        TraceWriter< key_type, data_type > m_trace;   //!< Where the calls go.
+
+    public:
+        //=== special members.
+        /// Records the calls on an empty dictionary into a new trace at `path`.
+        explicit RecordingDictionary( const std::string & path ) : m_dict(), m_trace( path ) { /* empty */ }
+        /// Records the calls on `dict`, moved in; the trace starts from its current contents.
+        RecordingDictionary( const std::string & path, Dict dict ) : m_dict( std::move( dict ) ), m_trace( path ) { /* empty */ }
+
+        //=== status members
+        size_t size (void) const{ return m_dict.size(); }
+        bool empty (void) const{ return m_dict.empty(); }
+        /// The wrapped dictionary, for unrecorded access.
+        Dict & dictionary (void){ return m_dict; }
+        const Dict & dictionary (void) const{ return m_dict; }
+        /// The trace, e.g. to close() it and check for I/O errors.
+        TraceWriter< key_type, data_type > & trace (void){ return m_trace; }
+
+        //=== recorded members
+        bool search (const key_type & key, data_type & data){
+            m_trace.search( key );
+            return m_dict.search( key, data );
+        }
+        key_type min (void){
+            m_trace.min();
+            return m_dict.min();
+        }
+        key_type max (void){
+            m_trace.max();
+            return m_dict.max();
+        }
+        bool predecessor (const key_type & _mKey, key_type & _newKey){
+            m_trace.predecessor( _mKey );
+            return m_dict.predecessor( _mKey, _newKey );
+        }
+        bool successor (const key_type & _mKey, key_type & _newKey){
+            m_trace.successor( _mKey );
+            return m_dict.successor( _mKey, _newKey );
+        }
+        bool insert (const key_type & _newKey, const data_type & _newInfo){
+            m_trace.insert( _newKey, _newInfo );
+            return m_dict.insert( _newKey, _newInfo );
+        }
+        bool remove (const key_type & _newKey, data_type & _newInfo){
+            m_trace.remove( _newKey );
+            return m_dict.remove( _newKey, _newInfo );
+        }
+};
+
+/// What replay_trace() measured.
+struct ReplayStats {
+    uint64_t events = 0;     //!< Operations replayed.
+    double seconds = 0;      //!< Wall time of the whole replay.
+    uint64_t checksum = 0;   //!< Checksum of every result, in order; equal for implementations that agree.
+    uint64_t op_events[dal_trace::OPS] = {};       //!< Operations replayed, per kind.
+    uint64_t op_checksum[dal_trace::OPS] = {};     //!< Checksum of the results, per kind.
+    LatencyHistogram latency[dal_trace::OPS];      //!< Latency per kind; empty unless requested.
+
+    double events_per_second (void) const{ return seconds > 0 ? events / seconds : 0.0; }
+};
+
+/// Replays `events` on `dict` and returns the throughput, the result checksums and, if `latencies`, the latency of every call.
+/*!
+ * The results folded into the checksums are the returned flags, the data
+ * found by search and moved out by remove, and the keys returned by min, max,
+ * predecessor and successor (min and max of an empty dictionary count as
+ * "no key"). Two implementations that agree on every call give the same
+ * checksums; comparing the per-operation checksums tells which kind of call
+ * differs first.
+ *
+ * Timing every call costs two clock reads per call; with `latencies` false
+ * only the whole replay is timed, for a cleaner throughput.
+ */
+template < typename Dict, typename KeyType, typename DataType >
+ReplayStats replay_trace( const std::vector< dal_trace::Event< KeyType, DataType > > & events, Dict & dict, bool latencies = true )
+{
+    typedef std::chrono::steady_clock Clock;
+    ReplayStats stats;
+    dal_snapshot::Checksum all, per[dal_trace::OPS];
+    auto fold = [&]( size_t op, bool flag, const void * bytes, size_t size ) {
+        uint8_t f = flag;
+        all.update( &f, 1 );
+        per[op].update( &f, 1 );
+        if ( flag ) {
+            all.update( bytes, size );
+            per[op].update( bytes, size );
+        }
+    };
+
+    Clock::time_point start = Clock::now();
+    for ( const auto & e : events ) {
+        Clock::time_point begin = latencies ? Clock::now() : Clock::time_point();
+        DataType data = DataType();
+        KeyType key = KeyType();
+        bool flag = false;
+        switch ( e.op ) {
+            case dal_trace::INSERT:      flag = dict.insert( e.key, e.data ); break;
+            case dal_trace::SEARCH:      flag = dict.search( e.key, data ); break;
+            case dal_trace::REMOVE:      flag = dict.remove( e.key, data ); break;
+            case dal_trace::PREDECESSOR: flag = dict.predecessor( e.key, key ); break;
+            case dal_trace::SUCCESSOR:   flag = dict.successor( e.key, key ); break;
+            default:
+                try {
+                    key = e.op == dal_trace::MIN ? dict.min() : dict.max();
+                    flag = true;
+                } catch ( std::out_of_range & ) {
+                    flag = false;
+                }
+        }
+        if ( latencies ) {
+            stats.latency[e.op].record( static_cast< uint64_t >(
+                std::chrono::duration_cast< std::chrono::nanoseconds >( Clock::now() - begin ).count() ) );
+        }
+        if ( e.op == dal_trace::SEARCH or e.op == dal_trace::REMOVE ) fold( e.op, flag, &data, sizeof( data ) );
+        else if ( e.op == dal_trace::INSERT ) fold( e.op, flag, nullptr, 0 );
+        else fold( e.op, flag, &key, sizeof( key ) );
+        stats.op_events[e.op]++;
+    }
+    stats.seconds = std::chrono::duration< double >( Clock::now() - start ).count();
+    stats.events = events.size();
+    stats.checksum = all.digest();
+    for ( size_t op = 0; op < dal_trace::OPS; ++op ) stats.op_checksum[op] = per[op].digest();
+    return stats;
+}
+
+#endif
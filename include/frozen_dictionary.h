@@ -0,0 +1,151 @@
+//! This class implements a read-only Dictionary.
+
+
+#ifndef _FROZEN_DICTIONARY_H_
+#define _FROZEN_DICTIONARY_H_
+
+#include <stdexcept>  // std::out_of_range
+#include <functional> // std::less<>()
+#include <vector>     // std::vector
+
+#include "dal.h"
+
+/// This class implements an immutable dictionary built from a DSAL, with keys in Eytzinger (BFS) order.
+/*!
+ * The sorted keys are laid out as an implicit complete binary search tree:
+ * node `k` (1-based) has its children at `2k` and `2k+1`. The top levels of the
+ * tree share a few cache lines, the search descends with no unpredictable
+ * branch (`k = 2k + (key[k] < x)`), and the cache line holding the
+ * descendants a few levels below is prefetched while the current level is
+ * compared. Data is kept in a separate array, in the same order, and read only
+ * on a hit.
+ *
+ * @tparam KeyType The key type.
+ * @tparam DataType Tha data type to be stored in the dictionary.
+ * @tparam KeyTypeLess A functor/function pointer that compares two keys for strict order <.
+ */
+template < typename KeyType, typename DataType, typename KeyTypeLess = std::less< KeyType > >
+class FrozenDictionary
+{
+    private:
+        /// Keys that fit in a cache line: the descendants `log2(BLOCK)` levels below node k start at node `k * BLOCK`.
+        static constexpr size_t BLOCK = sizeof( KeyType ) < 64 ? 64 / sizeof( KeyType ) : 1;
+
+        size_t m_length;              //!< Number of entries.
+        std::vector< KeyType > m_keys;  //!< Keys in Eytzinger order, 1-based (slot 0 is padding).
+        std::vector< DataType > m_data; //!< Data, parallel to the keys, 0-based (node k at k-1).
+        size_t m_min;                 //!< Node holding the smallest key.
+        size_t m_max;                 //!< Node holding the largest key.
+
+        /// Records, for each node of the subtree rooted at `k`, the rank of its key in sorted order.
+        void layout( size_t k, size_t & rank, std::vector< size_t > & rank_of ) const{
+            if ( k > m_length ) return;
+            layout( 2 * k, rank, rank_of );
+            rank_of[k] = rank++;
+            layout( 2 * k + 1, rank, rank_of );
+        }
+        /// Turns the final node of a descent into the node where it last went left (0 if it never did).
+        static size_t exit_node( size_t k ){
+            return k >> __builtin_ffsll( static_cast< long long >( ~k ) );
+        }
+        /// Node of the first key not less than `_mKey` (lower bound), or 0 if there is none.
+        size_t lower_bound_node( const KeyType & _mKey ) const{
+            KeyTypeLess less;
+            const KeyType * keys = m_keys.data();
+            size_t k = 1;
+            while ( k <= m_length ) {
+                size_t ahead = k * BLOCK;
+                if ( ahead <= m_length ) __builtin_prefetch( keys + ahead );
+                k = 2 * k + less( keys[k], _mKey );
+            }
+            return exit_node( k );
+        }
+        /// Node of the first key greater than `_mKey` (upper bound), or 0 if there is none.
+        size_t upper_bound_node( const KeyType & _mKey ) const{
+            KeyTypeLess less;
+            const KeyType * keys = m_keys.data();
+            size_t k = 1;
+            while ( k <= m_length ) {
+                size_t ahead = k * BLOCK;
+                if ( ahead <= m_length ) __builtin_prefetch( keys + ahead );
+                k = 2 * k + not less( _mKey, keys[k] );
+            }
+            return exit_node( k );
+        }
+        /// Node that comes right before node `k` in key order (0 if `k` holds the smallest key).
+        size_t previous_node( size_t k ) const{
+            if ( 2 * k <= m_length ) {
+                k = 2 * k;
+                while ( 2 * k + 1 <= m_length ) k = 2 * k + 1;
+                return k;
+            }
+            while ( k % 2 == 0 ) k /= 2;
+            return k / 2;
+        }
+
+    public:
+        //=== Alias
+        typedef KeyType key_type;   //!< The key type.
+        typedef DataType data_type; //!< The data type.
+
+        //=== special members.
+        /// Freezes the current contents of `source`, in O(n).
+        template < typename GrowthPolicy, typename Layout >
+        explicit FrozenDictionary( const DSAL< KeyType, DataType, KeyTypeLess, GrowthPolicy, Layout > & source )
+            : m_length{ source.size() }, m_min{ 0 }, m_max{ 0 }
+        {
+            std::vector< size_t > rank_of( m_length + 1, 0 );
+            size_t rank = 0;
+            layout( 1, rank, rank_of );
+
+            m_keys.reserve( m_length + 1 );
+            m_data.reserve( m_length );
+            if ( m_length > 0 ) m_keys.push_back( source.m_array.key( 0 ) ); // Padding.
+            for ( size_t k = 1; k <= m_length; ++k ) {
+                m_keys.push_back( source.m_array.key( rank_of[k] ) );
+                m_data.push_back( source.m_array.data( rank_of[k] ) );
+                if ( rank_of[k] == 0 ) m_min = k;
+                if ( rank_of[k] + 1 == m_length ) m_max = k;
+            }
+        }
+
+        //=== status members
+        size_t size (void) const { return m_length; }
+        bool empty (void) const { return m_length == 0; }
+
+        //=== acess members
+        /// Returns true and copies the data of `key` into `data` if it is stored; false otherwise.
+        bool search (const KeyType & key, DataType & data) const{
+            KeyTypeLess less;
+            size_t k = lower_bound_node( key );
+            if ( k == 0 or less( key, m_keys[k] ) ) return false;
+            data = m_data[k - 1];
+            return true;
+        }
+        KeyType min (void) const{
+            if ( empty() ) throw std::out_of_range("INVALID");
+            return m_keys[m_min];
+        }
+        KeyType max (void) const{
+            if ( empty() ) throw std::out_of_range("INVALID");
+            return m_keys[m_max];
+        }
+        /// Retrieves the largest key less than `_mKey` (which need not be stored); false if there is none.
+        bool predecessor (const KeyType & _mKey, KeyType & _newKey) const{
+            if ( empty() ) return false;
+            size_t k = lower_bound_node( _mKey );
+            k = ( k == 0 ) ? m_max : previous_node( k );
+            if ( k == 0 ) return false;
+            _newKey = m_keys[k];
+            return true;
+        }
+        /// Retrieves the smallest key greater than `_mKey` (which need not be stored); false if there is none.
+        bool successor (const KeyType & _mKey, KeyType & _newKey) const{
+            size_t k = upper_bound_node( _mKey );
+            if ( k == 0 ) return false;
+            _newKey = m_keys[k];
+            return true;
+        }
+};
+
+#endif
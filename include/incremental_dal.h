@@ -0,0 +1,378 @@
+//! This class implements an unsorted Dictionary that grows without stopping to copy the whole array.
+
+
+#ifndef _INCREMENTAL_DAL_H_
+#define _INCREMENTAL_DAL_H_
+
+#include <stdexcept>  // std::out_of_range
+#include <functional> // std::less<>()
+#include <algorithm>  // std::max(), std::nth_element()
+#include <utility>    // std::pair, std::move(), std::forward()
+#include <vector>     // std::vector
+
+#include "dal.h"
+
+/// This class implements a DAL whose growth is spread over the operations that follow it.
+/*!
+ * A full DAL moves every entry into a larger array inside one insert, a
+ * stall that grows with the table. Here a full array is only swapped for
+ * a larger, empty one: the old array is kept and each later insert or
+ * remove moves at most migration_step() of its entries over, so no single
+ * call moves more than that many entries. Lookups, min/max and the other
+ * queries read both arrays while a migration is running. The step is
+ * raised above the requested one if needed so the old array drains before
+ * the new one fills, e.g. to 2 with GrowthFactor<3, 2>.
+ *
+ * reserve(), shrink_to_fit(), copies and search_many() first finish (or,
+ * for the const ones, read through) a running migration.
+ *
+ * The DAL base is protected, since its lookups and emplace only see the new
+ * array.
+ *
+ * @tparam KeyType The key type.
+ * @tparam DataType Tha data type to be stored in the dictionary.
+ * @tparam KeyTypeLess A functor/function pointer that compares two keys for strict order <.
+ * @tparam GrowthPolicy Provides `static size_t next(size_t)`, the capacity to grow to when the array is full.
+ * @tparam Layout How entries are laid out in memory: `PairLayout` (interleaved pairs) or `SplitLayout` (separate key and data arrays).
+ */
+template < typename KeyType, typename DataType, typename KeyTypeLess = std::less< KeyType >, typename GrowthPolicy = GrowthFactor<2>, typename Layout = PairLayout >
+class IncrementalDAL : protected DAL< KeyType, DataType, KeyTypeLess, GrowthPolicy, Layout >
+{
+    private:
+        /// Alias for the parent class.
+        typedef DAL< KeyType, DataType, KeyTypeLess, GrowthPolicy, Layout > base_type;
+        /// Alias for the storage handle that implements the layout.
+        typedef typename base_type::storage_type storage_type;
+
+        static constexpr size_t STEP=16; //!< Default number of entries migrated per operation.
+
+        size_t m_migrate;            //!< Requested entries migrated per operation.
+        size_t m_step;               //!< Entries migrated per operation in the running migration.
+        storage_type m_old;          //!< The array being drained; only [0, m_old_length) holds entries.
+        size_t m_old_length;         //!< Entries left in the old array; 0 when no migration is running.
+        size_t m_old_capacity;       //!< Capacity of the old array.
+
+        /// Returns the index of `_mKey` in the old array, or m_old_length if it is not there.
+        size_t scan_old( const KeyType & _mKey ) const{
+            size_t i = 0;
+            while ( i < m_old_length and not ( _mKey == m_old.key(i) ) ) i++;
+            DAL_COUNT( comparisons, i < m_old_length ? i + 1 : m_old_length );
+            return i;
+        }
+        /// Calls `f(key)` for every key of both arrays.
+        template < typename F >
+        void for_each_key( F f ) const{
+            for ( size_t i = 0; i < this->m_length; ++i ) f( this->m_array.key(i) );
+            for ( size_t i = 0; i < m_old_length; ++i ) f( m_old.key(i) );
+        }
+        /// Moves up to `n` entries from the tail of the old array into the new one; releases the old array once empty.
+        void migrate( size_t n ){
+            size_t moved = 0;
+            for ( ; moved < n and m_old_length > 0; ++moved ) {
+                size_t last = m_old_length - 1;
+                this->m_array.construct( this->m_length, std::move( m_old.key(last) ), std::move( m_old.data(last) ) );
+                this->m_length++;
+                m_old.destroy( last, last + 1 );
+                m_old_length--;
+            }
+            DAL_COUNT( moves, moved );
+            DAL_COUNT( bytes_moved, moved * storage_type::entry_bytes );
+            if ( m_old_length == 0 and m_old_capacity > 0 ) {
+                m_old.deallocate( m_old_capacity );
+                m_old = storage_type();
+                m_old_capacity = 0;
+            }
+        }
+        /// Moves whatever is left of the old array.
+        void finish_migration(){
+            migrate( m_old_length );
+        }
+        /// Removes entry `i` of `a`, which holds `length` entries, moving the last entry into its place.
+        void erase_at( storage_type & a, size_t & length, size_t i ){
+            if ( i != length - 1 ) {
+                a.move_entry( i, length - 1 );
+                DAL_COUNT( moves, 1 );
+            }
+            length--;
+            a.destroy( length, length + 1 );
+        }
+        /// Stores a key that is in neither array; starts a migration if the new array is full.
+        template < typename K >
+        void append( K && _newKey, DataType && data ){
+            if ( this->m_length == this->m_capacity ) resize();
+            this->m_array.construct( this->m_length, std::forward< K >( _newKey ), std::move( data ) );
+            this->m_length++;
+            this->note_insert( this->m_array.key(this->m_length - 1) );
+            DAL_COUNT( inserts, 1 );
+        }
+
+    public:
+        //=== Alias
+        typedef KeyType key_type;   //!< The key type.
+        typedef DataType data_type; //!< The data type.
+
+        //=== special methods
+        /// Default constructor.
+        /*!
+         * @param capacity_ Initial capacity.
+         * @param migration_step Entries moved per operation while migrating; larger values finish sooner, smaller ones bound each call tighter.
+         */
+        IncrementalDAL( size_t capacity_ = base_type::SIZE, size_t migration_step = STEP )
+            : base_type( capacity_ ), m_migrate{ migration_step ? migration_step : 1 }, m_step{ m_migrate },
+              m_old(), m_old_length{ 0 }, m_old_capacity{ 0 }
+        { /* empty */ }
+        /// Destructor
+        virtual ~IncrementalDAL(){
+            m_old.destroy( 0, m_old_length );
+            if ( m_old_capacity > 0 ) m_old.deallocate( m_old_capacity );
+        }
+        /// Copy constructor; the copy holds every entry in a single array.
+        IncrementalDAL( const IncrementalDAL & other )
+            : base_type( other ), m_migrate{ other.m_migrate }, m_step{ other.m_migrate },
+              m_old(), m_old_length{ 0 }, m_old_capacity{ 0 }
+        {
+            // The new array always has room for what is left of the old one.
+            for ( size_t i = 0; i < other.m_old_length; ++i ) {
+                this->m_array.construct( this->m_length, other.m_old.key(i), other.m_old.data(i) );
+                this->m_length++;
+            }
+        }
+        /// Move constructor. The moved-from dictionary is left empty, with no capacity.
+        IncrementalDAL( IncrementalDAL && other ) noexcept
+            : base_type( std::move( other ) ), m_migrate{ other.m_migrate }, m_step{ other.m_step },
+              m_old( other.m_old ), m_old_length{ other.m_old_length }, m_old_capacity{ other.m_old_capacity }
+        {
+            other.m_old = storage_type();
+            other.m_old_length = 0;
+            other.m_old_capacity = 0;
+        }
+        /// Copy and move assignment (copy-and-swap).
+        IncrementalDAL & operator= ( IncrementalDAL other ){
+            swap( other );
+            return *this;
+        }
+        /// Exchanges the contents of two dictionaries in O(1).
+        void swap ( IncrementalDAL & other ) noexcept{
+            base_type::swap( other );
+            std::swap( m_migrate, other.m_migrate );
+            std::swap( m_step, other.m_step );
+            m_old.swap( other.m_old );
+            std::swap( m_old_length, other.m_old_length );
+            std::swap( m_old_capacity, other.m_old_capacity );
+        }
+
+        //=== status members
+        size_t size (void) const{
+            return this->m_length + m_old_length;
+        }
+        bool empty (void) const{
+            return size() == 0;
+        }
+        /// Whether entries are still waiting in the old array.
+        bool migrating (void) const{
+            return m_old_length > 0;
+        }
+        /// Most entries a single insert or remove moves.
+        size_t migration_step (void) const{
+            return m_step;
+        }
+        /// Makes room for at least `n` entries; finishes a running migration first.
+        void reserve ( size_t n ){
+            finish_migration();
+            base_type::reserve( n );
+        }
+        /// Releases the unused capacity; finishes a running migration first.
+        void shrink_to_fit (void){
+            finish_migration();
+            base_type::shrink_to_fit();
+        }
+        using base_type::capacity;
+        using base_type::stats_enabled;
+        using base_type::stats;
+        using base_type::reset_stats;
+
+        //=== acess members
+        bool search (const KeyType & key, DataType & data) const{
+            const DataType * p = find( key );
+            if ( p == nullptr ) return false;
+            data = *p;
+            return true;
+        }
+        /// Pointer to the data stored under `key` in either array, or nullptr; see DAL::find().
+        const DataType * find (const KeyType & key) const{
+            size_t i = this->scan_key( key );
+            if ( i < this->m_length ) return this->note_lookup( true ) ? &this->m_array.data(i) : nullptr;
+            size_t j = scan_old( key );
+            return this->note_lookup( j < m_old_length ) ? &m_old.data(j) : nullptr;
+        }
+        DataType * find (const KeyType & key){
+            return const_cast< DataType * >( static_cast< const IncrementalDAL & >( *this ).find( key ) );
+        }
+        /// Whether `key` is stored; the data is not touched.
+        bool contains (const KeyType & key) const{
+            return find( key ) != nullptr;
+        }
+        /// Looks up every key in [first, last); see DAL::search_many().
+        /*!
+         * While migrating the keys are searched one at a time, since the batched
+         * pass only reads the new array.
+         */
+        template < typename KeyIt, typename OutputIt >
+        size_t search_many( KeyIt first, KeyIt last, OutputIt out ) const{
+            if ( not migrating() ) return base_type::search_many( first, last, out );
+            size_t found = 0;
+            for ( ; first != last; ++first ) {
+                std::pair< bool, DataType > r( false, DataType() );
+                r.first = search( *first, r.second );
+                found += r.first;
+                *out++ = r;
+            }
+            return found;
+        }
+        /// Smallest key of both arrays, in O(1) from the cache; see DAL::min().
+        KeyType min (void) const{
+            if ( empty() ) throw std::out_of_range("INVALID");
+            return this->m_min;
+        }
+        /// Largest key of both arrays, in O(1) from the cache; see DAL::max().
+        KeyType max (void) const{
+            if ( empty() ) throw std::out_of_range("INVALID");
+            return this->m_max;
+        }
+        /// Largest key less than `_mKey`, which need not be stored, in a single pass over both arrays.
+        bool predecessor (const KeyType & _mKey, KeyType & _newKey){
+            KeyTypeLess less;
+            if ( empty() or not less( min(), _mKey ) ) return false;
+            const KeyType * best = nullptr;
+            for_each_key( [&]( const KeyType & k ) {
+                if ( less( k, _mKey ) and ( best == nullptr or less( *best, k ) ) ) best = &k;
+            } );
+            _newKey = *best;
+            return true;
+        }
+        /// Smallest key greater than `_mKey`, which need not be stored, in a single pass over both arrays.
+        bool successor (const KeyType & _mKey, KeyType & _newKey){
+            KeyTypeLess less;
+            if ( empty() or not less( _mKey, max() ) ) return false;
+            const KeyType * best = nullptr;
+            for_each_key( [&]( const KeyType & k ) {
+                if ( less( _mKey, k ) and ( best == nullptr or less( k, *best ) ) ) best = &k;
+            } );
+            _newKey = *best;
+            return true;
+        }
+        /// The `k`-th smallest key (from 0); see DAL::select().
+        KeyType select (size_t k) const{
+            if ( k >= size() ) throw std::out_of_range("INVALID");
+            std::vector< KeyType > keys;
+            keys.reserve( size() );
+            for_each_key( [&keys]( const KeyType & key ) { keys.push_back( key ); } );
+            std::nth_element( keys.begin(), keys.begin() + k, keys.end(), KeyTypeLess() );
+            return keys[k];
+        }
+        /// The `p`-th percentile of the keys, `p` in [0, 100] (nearest rank); see select().
+        KeyType percentile (double p) const{
+            if ( empty() ) throw std::out_of_range("INVALID");
+            return select( base_type::percentile_index( p, size() ) );
+        }
+
+        //=== modifier members.
+        /// Inserts a new entry; if the key already exists its data is overwritten and false is returned.
+        bool insert(const KeyType & _newKey, const DataType & _newInfo){
+            return emplace( _newKey, _newInfo );
+        }
+        /// Inserts a new entry moving key and data in; see insert(const KeyType &, const DataType &).
+        bool insert(KeyType && _newKey, DataType && _newInfo){
+            return emplace( std::move( _newKey ), std::move( _newInfo ) );
+        }
+        /// Inserts `_newKey` with data constructed from `args`; if the key exists its data is replaced and false is returned.
+        template < typename K, typename... Args >
+        bool emplace(K && _newKey, Args &&... args){
+            if ( DataType * p = find_slot( _newKey ) ) {
+                *p = DataType( std::forward< Args >( args )... );
+                DAL_COUNT( updates, 1 );
+                migrate( m_step );
+                return false;
+            }
+            append( std::forward< K >( _newKey ), DataType( std::forward< Args >( args )... ) );
+            migrate( m_step );
+            return true;
+        }
+        /// Like emplace(), but leaves an existing entry untouched (and `args` unused) if the key is already stored.
+        template < typename K, typename... Args >
+        bool try_emplace(K && _newKey, Args &&... args){
+            if ( find_slot( _newKey ) != nullptr ) {
+                DAL_COUNT( updates, 1 );
+                migrate( m_step );
+                return false;
+            }
+            append( std::forward< K >( _newKey ), DataType( std::forward< Args >( args )... ) );
+            migrate( m_step );
+            return true;
+        }
+        /// Removes `_newKey` from whichever array holds it, moving its data into `_newInfo`; see DAL::extract().
+        bool extract(const KeyType & _newKey, DataType & _newInfo){
+            size_t i = this->scan_key( _newKey );
+            size_t j = i < this->m_length ? m_old_length : scan_old( _newKey );
+            if ( i == this->m_length and j == m_old_length ) {
+                DAL_COUNT( remove_misses, 1 );
+                migrate( m_step );
+                return false;
+            }
+            storage_type & a = i < this->m_length ? this->m_array : m_old;
+            size_t & length = i < this->m_length ? this->m_length : m_old_length;
+            size_t at = i < this->m_length ? i : j;
+            _newInfo = std::move( a.data(at) );
+            bool extreme = this->removes_extreme( a.key(at) );
+            erase_at( a, length, at );
+            if ( extreme ) refresh();
+            DAL_COUNT( remove_hits, 1 );
+            migrate( m_step );
+            return true;
+        }
+        using base_type::remove;
+        /// Starts a migration into an array grown as dictated by the growth policy; the entries move over later.
+        void resize(){
+            finish_migration();
+            size_t capacity = GrowthPolicy::next( this->m_capacity );
+            storage_type fresh;
+            fresh.allocate( capacity );
+            m_old = this->m_array;
+            m_old_length = this->m_length;
+            m_old_capacity = this->m_capacity;
+            this->m_array = fresh;
+            this->m_length = 0;
+            this->m_capacity = capacity;
+            // Drain the old array before the new one can fill: m_old_length / m_step inserts must fit in the spare room.
+            size_t room = capacity - m_old_length;
+            m_step = std::max( m_migrate, ( m_old_length + room - 1 ) / room );
+            DAL_COUNT( resizes, 1 );
+            DAL_COUNT( bytes_allocated, capacity * storage_type::entry_bytes );
+            if ( m_old_length == 0 ) migrate( 0 );
+        }
+
+    protected:
+        /// Pointer to the data of `_mKey` in either array, or nullptr; not counted as a lookup.
+        DataType * find_slot( const KeyType & _mKey ){
+            size_t i = this->scan_key( _mKey );
+            if ( i < this->m_length ) return &this->m_array.data(i);
+            size_t j = scan_old( _mKey );
+            return j < m_old_length ? &m_old.data(j) : nullptr;
+        }
+        /// Refills the min/max cache from both arrays; it is left invalid if both are empty.
+        /*!
+         * Migration only moves entries between the arrays, so a valid cache stays valid across it.
+         */
+        void refresh(){
+            KeyTypeLess less;
+            bool first = true;
+            for_each_key( [&]( const KeyType & k ) {
+                if ( first or less( k, this->m_min ) ) this->m_min = k;
+                if ( first or less( this->m_max, k ) ) this->m_max = k;
+                first = false;
+            } );
+            this->m_extremes_valid = not first;
+        }
+};
+
+#endif
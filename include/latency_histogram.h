@@ -0,0 +1,225 @@
+//! Log-bucketed latency histogram and a Dictionary wrapper that times every operation.
+
+
+#ifndef _LATENCY_HISTOGRAM_H_
+#define _LATENCY_HISTOGRAM_H_
+
+#include <stdexcept>  // std::out_of_range
+#include <vector>     // std::vector
+#include <string>     // std::string
+#include <ostream>    // std::ostream
+#include <chrono>     // steady_clock
+#include <cmath>      // std::ceil()
+#include <cstdint>    // uint64_t
+#include <utility>    // std::move()
+#include <algorithm>  // std::min(), std::max(), std::fill()
+
+/// This class implements a histogram of latencies with a bounded relative error, HDR style.
+/*!
+ * Values (nanoseconds) below 2^SUB_BITS each get their own bucket; above that
+ * every power of two is split in 2^SUB_BITS equal buckets, so a value is
+ * reported with a relative error below 2^-SUB_BITS (about 3%) whatever its
+ * magnitude, from nanoseconds to hours, in a fixed array of counters.
+ * Recording is a bit scan and an increment, with no allocation.
+ *
+ * A histogram is not thread-safe: give each thread its own and merge() them.
+ */
+class LatencyHistogram
+{
+    public:
+        static constexpr unsigned SUB_BITS = 5;                             //!< Buckets per power of two: 2^SUB_BITS.
+        static constexpr size_t SUB_COUNT = size_t( 1 ) << SUB_BITS;        //!< Values below this are exact.
+        static constexpr size_t BUCKETS = ( 64 - SUB_BITS + 1 ) * SUB_COUNT; //!< Enough for any uint64_t.
+
+        LatencyHistogram() : m_counts( BUCKETS, 0 ), m_count{ 0 }, m_sum{ 0 }, m_min{ UINT64_MAX }, m_max{ 0 } { /* empty */ }
+
+        /// Records one latency of `ns` nanoseconds.
+        void record( uint64_t ns ){
+            m_counts[ bucket( ns ) ]++;
+            m_count++;
+            m_sum += ns;
+            if ( ns < m_min ) m_min = ns;
+            if ( ns > m_max ) m_max = ns;
+        }
+        /// Adds the latencies recorded by `other`, e.g. by another thread.
+        void merge( const LatencyHistogram & other ){
+            for ( size_t b = 0; b < BUCKETS; ++b ) m_counts[b] += other.m_counts[b];
+            m_count += other.m_count;
+            m_sum += other.m_sum;
+            if ( other.m_min < m_min ) m_min = other.m_min;
+            if ( other.m_max > m_max ) m_max = other.m_max;
+        }
+        /// Forgets every latency.
+        void reset(){
+            std::fill( m_counts.begin(), m_counts.end(), 0 );
+            m_count = 0;
+            m_sum = 0;
+            m_min = UINT64_MAX;
+            m_max = 0;
+        }
+
+        //=== status members
+        uint64_t count (void) const{ return m_count; }
+        bool empty (void) const{ return m_count == 0; }
+        /// Smallest and largest latencies, exact; throw std::out_of_range if empty.
+        uint64_t min (void) const{
+            if ( empty() ) throw std::out_of_range("INVALID");
+            return m_min;
+        }
+        uint64_t max (void) const{
+            if ( empty() ) throw std::out_of_range("INVALID");
+            return m_max;
+        }
+        /// Mean latency, exact; 0 if empty.
+        double mean (void) const{ return empty() ? 0.0 : static_cast< double >( m_sum ) / m_count; }
+        /// The `p`-th percentile, `p` in [0, 100] (nearest rank), as the top of its bucket and never above max().
+        uint64_t percentile (double p) const{
+            if ( empty() or not ( p >= 0 and p <= 100 ) ) throw std::out_of_range("INVALID");
+            uint64_t rank = static_cast< uint64_t >( std::ceil( p / 100 * m_count ) );
+            if ( rank == 0 ) rank = 1;
+            uint64_t seen = 0;
+            for ( size_t b = 0; b < BUCKETS; ++b ) {
+                seen += m_counts[b];
+                if ( seen >= rank ) return std::max( m_min, std::min( highest( b ), m_max ) );
+            }
+            return m_max;
+        }
+
+        //=== reports
+        /// One line: `name count=N mean=... p50=... p90=... p99=... p99.9=... max=...`, in nanoseconds.
+        void write_text( std::ostream & out, const std::string & name ) const{
+            out << name << " count=" << m_count;
+            if ( not empty() ) {
+                out << " mean=" << static_cast< uint64_t >( mean() ) << "ns p50=" << percentile( 50 ) << "ns p90=" << percentile( 90 )
+                    << "ns p99=" << percentile( 99 ) << "ns p99.9=" << percentile( 99.9 ) << "ns max=" << m_max << "ns";
+            }
+            out << '\n';
+        }
+        /// A JSON object with the same fields as write_text(), in nanoseconds; percentiles are 0 if empty.
+        void write_json( std::ostream & out ) const{
+            bool e = empty();
+            out << "{\"count\":" << m_count << ",\"mean_ns\":" << mean()
+                << ",\"p50_ns\":" << ( e ? 0 : percentile( 50 ) ) << ",\"p90_ns\":" << ( e ? 0 : percentile( 90 ) )
+                << ",\"p99_ns\":" << ( e ? 0 : percentile( 99 ) ) << ",\"p999_ns\":" << ( e ? 0 : percentile( 99.9 ) )
+                << ",\"max_ns\":" << m_max << "}";
+        }
+
+        //=== buckets
+        /// Bucket of `ns`.
+        static size_t bucket( uint64_t ns ){
+            if ( ns < SUB_COUNT ) return static_cast< size_t >( ns );
+            unsigned shift = 63 - __builtin_clzll( ns ) - SUB_BITS;
+            return ( shift + 1 ) * SUB_COUNT + static_cast< size_t >( ( ns >> shift ) - SUB_COUNT );
+        }
+        /// Largest value that falls in bucket `b`.
+        static uint64_t highest( size_t b ){
+            if ( b < SUB_COUNT ) return b;
+            unsigned shift = static_cast< unsigned >( b / SUB_COUNT - 1 );
+            uint64_t sub = b % SUB_COUNT + SUB_COUNT;
+            return ( ( sub + 1 ) << shift ) - 1;
+        }
+
+    private:
+        std::vector< uint64_t > m_counts; //!< Latencies per bucket.
+        uint64_t m_count;                 //!< Latencies recorded.
+        uint64_t m_sum;                   //!< Their sum, for the mean.
+        uint64_t m_min;                   //!< Smallest latency, UINT64_MAX if none.
+        uint64_t m_max;                   //!< Largest latency, 0 if none.
+};
+
+/// This class implements a Dictionary wrapper that records the latency of every insert, search and remove.
+/*!
+ * Each call is timed with std::chrono::steady_clock (a vDSO read of the
+ * monotonic clock on Linux, some 20 ns) into one LatencyHistogram per
+ * operation, so the rare slow calls (a resize, a long shift) show up in the
+ * high percentiles instead of vanishing in an average. Other members are
+ * reached untimed through dictionary().
+ *
+ * Not thread-safe, like the dictionaries it wraps; to time several threads give
+ * each its own histograms and merge() them.
+ *
+ * @tparam Dict The dictionary type (DAL, DSAL, DHT, ...); must provide `key_type` and `data_type`.
+ */
+template < typename Dict >
+class TimedDictionary
+{
+    public:
+        //=== Alias
+        typedef typename Dict::key_type key_type;   //!< The key type.
+        typedef typename Dict::data_type data_type; //!< The data type.
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        Dict m_dict;                 //!< The timed dictionary.
+        LatencyHistogram m_insert;   //!< Latencies of insert().
+        LatencyHistogram m_search;   //!< Latencies of search().
+        LatencyHistogram m_remove;   //!< Latencies of remove().
+
+        /// Nanoseconds since `start`.
+        static uint64_t elapsed( Clock::time_point start ){
+            return static_cast< uint64_t >( std::chrono::duration_cast< std::chrono::nanoseconds >( Clock::now() - start ).count() );
+        }
+
+    public:
+        //=== special members.
+        TimedDictionary() = default;
+        /// Times the operations on `dict`, moved in.
+        explicit TimedDictionary( Dict dict ) : m_dict( std::move( dict ) ) { /* empty */ }
+
+        //=== status members
+        size_t size (void) const{ return m_dict.size(); }
+        bool empty (void) const{ return m_dict.empty(); }
+        /// The wrapped dictionary, for untimed access.
+        Dict & dictionary (void){ return m_dict; }
+        const Dict & dictionary (void) const{ return m_dict; }
+
+        //=== latencies
+        const LatencyHistogram & insert_latency (void) const{ return m_insert; }
+        const LatencyHistogram & search_latency (void) const{ return m_search; }
+        const LatencyHistogram & remove_latency (void) const{ return m_remove; }
+        /// Forgets the latencies recorded so far.
+        void reset_latencies (void){
+            m_insert.reset();
+            m_search.reset();
+            m_remove.reset();
+        }
+        /// One write_text() line per operation.
+        void write_text( std::ostream & out ) const{
+            m_insert.write_text( out, "insert" );
+            m_search.write_text( out, "search" );
+            m_remove.write_text( out, "remove" );
+        }
+        /// A JSON object with one write_json() object per operation.
+        void write_json( std::ostream & out ) const{
+            out << "{\"insert\":";
+            m_insert.write_json( out );
+            out << ",\"search\":";
+            m_search.write_json( out );
+            out << ",\"remove\":";
+            m_remove.write_json( out );
+            out << "}";
+        }
+
+        //=== timed members
+        bool search (const key_type & key, data_type & data){
+            Clock::time_point start = Clock::now();
+            bool found = m_dict.search( key, data );
+            m_search.record( elapsed( start ) );
+            return found;
+        }
+        bool insert (const key_type & _newKey, const data_type & _newInfo){
+            Clock::time_point start = Clock::now();
+            bool added = m_dict.insert( _newKey, _newInfo );
+            m_insert.record( elapsed( start ) );
+            return added;
+        }
+        bool remove (const key_type & _newKey, data_type & _newInfo){
+            Clock::time_point start = Clock::now();
+            bool removed = m_dict.remove( _newKey, _newInfo );
+            m_remove.record( elapsed( start ) );
+            return removed;
+        }
+};
+
+#endif
@@ -0,0 +1,280 @@
+//! This class implements a read-only Dictionary served from a memory-mapped snapshot.
+
+
+#ifndef _MAPPED_DICTIONARY_H_
+#define _MAPPED_DICTIONARY_H_
+
+#include <stdexcept>  // std::out_of_range, std::runtime_error
+#include <functional> // std::less<>()
+#include <string>     // std::string
+#include <utility>    // std::pair
+#include <iterator>   // std::bidirectional_iterator_tag
+#include <cstring>    // std::memcpy()
+#include <type_traits> // std::is_trivially_copyable
+
+#include <fcntl.h>    // open()
+#include <sys/mman.h> // mmap(), munmap()
+#include <sys/stat.h> // fstat()
+#include <unistd.h>   // close()
+
+#include "dal.h"
+#include "dal_snapshot.h"
+
+/// This class implements an immutable dictionary that reads a DSAL snapshot in place, through a read-only mapping.
+/*!
+ * Opening maps the file written by DSAL::save() and checks its header; keys
+ * and data are then used straight from the mapping, with no deserialization,
+ * so opening costs the same for any table size and pages are only read from
+ * disk when a lookup touches them. Several processes mapping the same file
+ * share its pages.
+ *
+ * The payload checksum is not checked on open, since that reads the whole
+ * file; call verify() for that.
+ *
+ * @tparam KeyType The key type; trivially copyable.
+ * @tparam DataType Tha data type; trivially copyable.
+ * @tparam KeyTypeLess A functor/function pointer that compares two keys for strict order <; must match the saved DSAL.
+ */
+template < typename KeyType, typename DataType, typename KeyTypeLess = std::less< KeyType > >
+class MappedDictionary
+{
+    static_assert( std::is_trivially_copyable< KeyType >::value and std::is_trivially_copyable< DataType >::value,
+                   "Snapshots store keys and data as raw bytes." );
+    static_assert( alignof( KeyType ) <= dal_snapshot::ALIGNMENT and alignof( DataType ) <= dal_snapshot::ALIGNMENT,
+                   "Snapshot arrays are only aligned to dal_snapshot::ALIGNMENT." );
+
+    public:
+        //=== Alias
+        typedef KeyType key_type;   //!< The key type.
+        typedef DataType data_type; //!< The data type.
+
+        /// Read-only iterator over the sorted entries; see DSAL::const_iterator.
+        class const_iterator {
+            public:
+                typedef std::bidirectional_iterator_tag iterator_category;
+                typedef std::pair< const KeyType &, const DataType & > value_type;
+                typedef value_type reference;
+                typedef std::ptrdiff_t difference_type;
+                typedef void pointer;
+
+                const_iterator() : m_owner{ nullptr }, m_index{ 0 } { /* empty */ }
+
+                const KeyType & key (void) const{ return m_owner->m_keys[m_index]; }
+                const DataType & data (void) const{ return m_owner->m_data[m_index]; }
+                reference operator* () const{ return reference( key(), data() ); }
+
+                const_iterator & operator++ (){ ++m_index; return *this; }
+                const_iterator operator++ (int){ const_iterator old = *this; ++m_index; return old; }
+                const_iterator & operator-- (){ --m_index; return *this; }
+                const_iterator operator-- (int){ const_iterator old = *this; --m_index; return old; }
+                difference_type operator- (const const_iterator & other) const{
+                    return static_cast< difference_type >( m_index ) - static_cast< difference_type >( other.m_index );
+                }
+                bool operator== (const const_iterator & other) const{ return m_index == other.m_index and m_owner == other.m_owner; }
+                bool operator!= (const const_iterator & other) const{ return not ( *this == other ); }
+                /// Position of the entry in the sorted arrays.
+                size_t index (void) const{ return m_index; }
+
+            private:
+                friend class MappedDictionary;
+                const_iterator( const MappedDictionary * owner, size_t index ) : m_owner{ owner }, m_index{ index } { /* empty */ }
+
+                const MappedDictionary * m_owner; //!< The dictionary iterated.
+                size_t m_index;                   //!< Current entry.
+        };
+
+        /// A pair of iterators, usable in a range-based for.
+        class range_type {
+            public:
+                range_type( const_iterator first, const_iterator last ) : m_first{ first }, m_last{ last } { /* empty */ }
+                const_iterator begin (void) const{ return m_first; }
+                const_iterator end (void) const{ return m_last; }
+                size_t size (void) const{ return static_cast< size_t >( m_last - m_first ); }
+                bool empty (void) const{ return m_first == m_last; }
+
+            private:
+                const_iterator m_first; //!< First entry of the range.
+                const_iterator m_last;  //!< One past the last entry.
+        };
+
+    private:
+        void * m_map;            //!< The mapping, or nullptr once moved from.
+        size_t m_bytes;          //!< Length of the mapping.
+        size_t m_length;         //!< Number of entries.
+        const KeyType * m_keys;  //!< Sorted keys, inside the mapping.
+        const DataType * m_data; //!< Data, parallel to the keys, inside the mapping.
+        uint64_t m_payload_sum;  //!< Checksum recorded by save().
+
+        /// Returns the index of the first key not less than `_mKey` (binary search).
+        size_t lower_bound_index( const KeyType & _mKey ) const{
+            KeyTypeLess less;
+            size_t begin = 0;
+            size_t count = m_length;
+            while ( count > 0 ) {
+                size_t half = count / 2;
+                if ( less( m_keys[begin + half], _mKey ) ) {
+                    begin += half + 1;
+                    count -= half + 1;
+                } else {
+                    count = half;
+                }
+            }
+            return begin;
+        }
+        /// Returns the index of the first key greater than `_mKey` (binary search).
+        size_t upper_bound_index( const KeyType & _mKey ) const{
+            KeyTypeLess less;
+            size_t begin = 0;
+            size_t count = m_length;
+            while ( count > 0 ) {
+                size_t half = count / 2;
+                if ( not less( _mKey, m_keys[begin + half] ) ) {
+                    begin += half + 1;
+                    count -= half + 1;
+                } else {
+                    count = half;
+                }
+            }
+            return begin;
+        }
+        /// Unmaps the file, if mapped.
+        void release(){
+            if ( m_map != nullptr ) munmap( m_map, m_bytes );
+            m_map = nullptr;
+        }
+
+    public:
+        //=== special members.
+        /// Maps the snapshot at `path`; throws std::runtime_error if it cannot be read or was saved with other types.
+        explicit MappedDictionary( const std::string & path )
+            : m_map{ nullptr }, m_bytes{ 0 }, m_length{ 0 }, m_keys{ nullptr }, m_data{ nullptr }, m_payload_sum{ 0 }
+        {
+            int fd = ::open( path.c_str(), O_RDONLY );
+            if ( fd < 0 ) throw std::runtime_error( "MappedDictionary: cannot open " + path );
+            struct stat st;
+            if ( fstat( fd, &st ) != 0 or static_cast< uint64_t >( st.st_size ) < sizeof( dal_snapshot::Header ) ) {
+                close( fd );
+                throw std::runtime_error( "MappedDictionary: not a snapshot: " + path );
+            }
+            m_bytes = static_cast< size_t >( st.st_size );
+            void * map = mmap( nullptr, m_bytes, PROT_READ, MAP_SHARED, fd, 0 );
+            close( fd ); // The mapping keeps the file alive.
+            if ( map == MAP_FAILED ) throw std::runtime_error( "MappedDictionary: cannot map " + path );
+            m_map = map;
+
+            dal_snapshot::Header h;
+            std::memcpy( &h, m_map, sizeof( h ) );
+            bool valid = dal_snapshot::compatible( h, sizeof( KeyType ), sizeof( DataType ) )
+                and h.file_size == m_bytes
+                and h.keys_offset % dal_snapshot::ALIGNMENT == 0 and h.data_offset % dal_snapshot::ALIGNMENT == 0
+                // Bound the offsets and counts before adding them up, so a forged header cannot wrap around.
+                and h.keys_offset >= sizeof( h ) and h.keys_offset <= m_bytes and h.data_offset <= m_bytes
+                and h.count <= ( m_bytes - h.keys_offset ) / sizeof( KeyType )
+                and h.count <= ( m_bytes - h.data_offset ) / sizeof( DataType )
+                and h.keys_offset + h.count * sizeof( KeyType ) <= h.data_offset
+                and h.data_offset + h.count * sizeof( DataType ) == h.file_size;
+            if ( not valid ) {
+                release();
+                throw std::runtime_error( "MappedDictionary: not a snapshot of this key/data type: " + path );
+            }
+            const char * base = static_cast< const char * >( m_map );
+            m_length = static_cast< size_t >( h.count );
+            m_keys = reinterpret_cast< const KeyType * >( base + h.keys_offset );
+            m_data = reinterpret_cast< const DataType * >( base + h.data_offset );
+            m_payload_sum = h.payload_sum;
+        }
+        /// Destructor; unmaps the file.
+        ~MappedDictionary(){ release(); }
+        /// Move constructor and assignment; the moved-from dictionary is left empty.
+        MappedDictionary( MappedDictionary && other ) noexcept
+            : m_map{ other.m_map }, m_bytes{ other.m_bytes }, m_length{ other.m_length },
+              m_keys{ other.m_keys }, m_data{ other.m_data }, m_payload_sum{ other.m_payload_sum }
+        {
+            other.m_map = nullptr;
+            other.m_length = 0;
+        }
+        MappedDictionary & operator= ( MappedDictionary && other ) noexcept{
+            if ( this != &other ) {
+                release();
+                m_map = other.m_map;
+                m_bytes = other.m_bytes;
+                m_length = other.m_length;
+                m_keys = other.m_keys;
+                m_data = other.m_data;
+                m_payload_sum = other.m_payload_sum;
+                other.m_map = nullptr;
+                other.m_length = 0;
+            }
+            return *this;
+        }
+        MappedDictionary( const MappedDictionary & ) = delete;
+        MappedDictionary & operator= ( const MappedDictionary & ) = delete;
+
+        //=== status members
+        size_t size (void) const { return m_length; }
+        bool empty (void) const { return m_length == 0; }
+        /// Reads the whole payload and compares it with the checksum recorded by save().
+        bool verify (void) const{
+            if ( m_map == nullptr ) return true;
+            dal_snapshot::Checksum sum;
+            sum.update( m_keys, m_length * sizeof( KeyType ) );
+            sum.update( m_data, m_length * sizeof( DataType ) );
+            return sum.digest() == m_payload_sum;
+        }
+
+        //=== acess members
+        /// Returns true and copies the data of `key` into `data` if it is stored; false otherwise.
+        bool search (const KeyType & key, DataType & data) const{
+            const DataType * p = find( key );
+            if ( p == nullptr ) return false;
+            data = *p;
+            return true;
+        }
+        /// Pointer into the mapping to the data of `key`, or nullptr.
+        const DataType * find (const KeyType & key) const{
+            KeyTypeLess less;
+            size_t i = lower_bound_index( key );
+            return i < m_length and not less( key, m_keys[i] ) ? &m_data[i] : nullptr;
+        }
+        bool contains (const KeyType & key) const{ return find( key ) != nullptr; }
+        KeyType min (void) const{
+            if ( empty() ) throw std::out_of_range("INVALID");
+            return m_keys[0];
+        }
+        KeyType max (void) const{
+            if ( empty() ) throw std::out_of_range("INVALID");
+            return m_keys[m_length - 1];
+        }
+        /// Retrieves the largest key less than `_mKey` (which need not be stored); false if there is none.
+        bool predecessor (const KeyType & _mKey, KeyType & _newKey) const{
+            size_t i = lower_bound_index( _mKey );
+            if ( i == 0 ) return false;
+            _newKey = m_keys[i - 1];
+            return true;
+        }
+        /// Retrieves the smallest key greater than `_mKey` (which need not be stored); false if there is none.
+        bool successor (const KeyType & _mKey, KeyType & _newKey) const{
+            size_t i = upper_bound_index( _mKey );
+            if ( i == m_length ) return false;
+            _newKey = m_keys[i];
+            return true;
+        }
+
+        //=== Ordered queries
+        const_iterator lower_bound (const KeyType & _mKey) const{ return const_iterator( this, lower_bound_index( _mKey ) ); }
+        const_iterator upper_bound (const KeyType & _mKey) const{ return const_iterator( this, upper_bound_index( _mKey ) ); }
+        std::pair< const_iterator, const_iterator > equal_range (const KeyType & _mKey) const{
+            return std::make_pair( lower_bound( _mKey ), upper_bound( _mKey ) );
+        }
+        /// The entries with keys in the closed interval [lo, hi]; empty if hi < lo.
+        range_type range (const KeyType & lo, const KeyType & hi) const{
+            KeyTypeLess less;
+            const_iterator first = lower_bound( lo );
+            if ( less( hi, lo ) ) return range_type( first, first );
+            return range_type( first, upper_bound( hi ) );
+        }
+        const_iterator begin (void) const{ return const_iterator( this, 0 ); }
+        const_iterator end (void) const{ return const_iterator( this, m_length ); }
+};
+
+#endif
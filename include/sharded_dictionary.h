@@ -0,0 +1,128 @@
+//! This class implements a thread-safe Dictionary made of independent shards.
+
+
+#ifndef _SHARDED_DICTIONARY_H_
+#define _SHARDED_DICTIONARY_H_
+
+#include <stdexcept>    // std::out_of_range
+#include <functional>   // std::hash<>, std::less<>
+#include <mutex>        // std::unique_lock
+#include <shared_mutex> // std::shared_mutex, std::shared_lock
+#include <cstdint>      // uint64_t
+
+/// This class implements a dictionary that can be shared between threads, built from N shards.
+/*!
+ * Each key belongs to one shard, chosen by its hash. A shard is a `Dict` (DAL,
+ * DSAL, DHT, ...) guarded by its own reader-writer lock, so threads working on
+ * different shards never wait for each other and lookups on the same shard
+ * run concurrently. Shards are aligned to cache lines to avoid false sharing
+ * between their locks.
+ *
+ * size(), min() and max() visit the shards one at a time, each under its
+ * shared lock; under concurrent writes they return a value that was valid for
+ * every shard at the time it was visited, not a snapshot of the whole dictionary.
+ *
+ * @tparam Dict The dictionary type of each shard; must provide `key_type` and `data_type`.
+ * @tparam N Number of shards.
+ * @tparam Hash A functor that hashes a key into a size_t.
+ * @tparam KeyTypeLess The order used by the shards, to combine their min() and max().
+ */
+template < typename Dict, size_t N, typename Hash = std::hash< typename Dict::key_type >,
+           typename KeyTypeLess = std::less< typename Dict::key_type > >
+class ShardedDictionary
+{
+    static_assert( N > 0, "A sharded dictionary needs at least one shard." );
+
+    public:
+        //=== Alias
+        typedef typename Dict::key_type key_type;   //!< The key type.
+        typedef typename Dict::data_type data_type; //!< The data type.
+
+    private:
+        /// A dictionary and the lock that guards it.
+        struct alignas( 64 ) Shard {
+            mutable std::shared_mutex lock; //!< Shared for reads, exclusive for writes.
+            Dict dict;                      //!< The entries of this shard.
+        };
+
+        Shard m_shards[N]; //!< The shards.
+
+        /// Shard of `_mKey`.
+        Shard & shard( const key_type & _mKey ){ return m_shards[ index( _mKey ) ]; }
+        const Shard & shard( const key_type & _mKey ) const{ return m_shards[ index( _mKey ) ]; }
+        /// Index of the shard of `_mKey`.
+        /*!
+         * The hash is mixed with a different function than the one DHT uses for its
+         * slots, so the keys of one shard still spread over a hash table inside it.
+         */
+        static size_t index( const key_type & _mKey ){
+            uint64_t h = static_cast< uint64_t >( Hash()( _mKey ) );
+            h ^= h >> 33;
+            h *= 0xFF51AFD7ED558CCDULL;
+            h ^= h >> 33;
+            return static_cast< size_t >( h % N );
+        }
+
+        /// Combines the smallest (or largest) key of every non-empty shard.
+        key_type extreme( bool smallest ) const{
+            KeyTypeLess less;
+            bool found = false;
+            key_type best{};
+            for ( const Shard & s : m_shards ) {
+                std::shared_lock< std::shared_mutex > guard( s.lock );
+                if ( s.dict.empty() ) continue;
+                key_type candidate = smallest ? s.dict.min() : s.dict.max();
+                if ( not found or ( smallest ? less( candidate, best ) : less( best, candidate ) ) ) best = candidate;
+                found = true;
+            }
+            if ( not found ) throw std::out_of_range("INVALID");
+            return best;
+        }
+
+    public:
+        //=== special members.
+        ShardedDictionary() = default;
+        ShardedDictionary( const ShardedDictionary & ) = delete;
+        ShardedDictionary & operator= ( const ShardedDictionary & ) = delete;
+
+        //=== status members
+        size_t size (void) const{
+            size_t total = 0;
+            for ( const Shard & s : m_shards ) {
+                std::shared_lock< std::shared_mutex > guard( s.lock );
+                total += s.dict.size();
+            }
+            return total;
+        }
+        bool empty (void) const{ return size() == 0; }
+        /// Number of shards.
+        static constexpr size_t shards (void){ return N; }
+
+        //=== acess members
+        bool search (const key_type & key, data_type & data) const{
+            const Shard & s = shard( key );
+            std::shared_lock< std::shared_mutex > guard( s.lock );
+            return s.dict.search( key, data );
+        }
+        key_type min (void) const{
+            return extreme( true );
+        }
+        key_type max (void) const{
+            return extreme( false );
+        }
+
+        //=== modifier members.
+        /// Inserts a new entry; if the key already exists its data is overwritten and false is returned.
+        bool insert (const key_type & _newKey, const data_type & _newInfo){
+            Shard & s = shard( _newKey );
+            std::unique_lock< std::shared_mutex > guard( s.lock );
+            return s.dict.insert( _newKey, _newInfo );
+        }
+        bool remove (const key_type & _newKey, data_type & _newInfo){
+            Shard & s = shard( _newKey );
+            std::unique_lock< std::shared_mutex > guard( s.lock );
+            return s.dict.remove( _newKey, _newInfo );
+        }
+};
+
+#endif
@@ -0,0 +1,173 @@
+//! This class implements a read-mostly Dictionary with lock-free readers.
+
+
+#ifndef _SNAPSHOT_DICTIONARY_H_
+#define _SNAPSHOT_DICTIONARY_H_
+
+#include <stdexcept>  // std::runtime_error
+#include <atomic>     // std::atomic
+#include <mutex>      // std::mutex, std::lock_guard
+#include <memory>     // std::unique_ptr
+#include <vector>     // std::vector
+#include <utility>    // std::pair
+#include <cstdint>    // uint64_t
+
+/// This class implements a dictionary whose readers never lock, for tables that are read far more than written.
+/*!
+ * The current contents are an immutable `Dict` (typically a DSAL) published
+ * through an atomic pointer. A reader announces the epoch it started in, loads
+ * the pointer and reads the snapshot directly, with no lock and no shared
+ * counter to bump. A writer copies the current snapshot, applies a batch of
+ * changes to the copy and publishes it (RCU style); writers are serialized by
+ * a mutex.
+ *
+ * The replaced snapshot is retired with a new epoch and deleted once no reader
+ * that may still see it is active, i.e. once every active reader announced an
+ * epoch at least as recent (epoch-based reclamation).
+ *
+ * Readers go through a Reader handle, which owns one of `MaxReaders` slots
+ * where the reader announces its epoch; each thread should use its own handle.
+ *
+ * @tparam Dict The dictionary type of the snapshots; must provide `key_type`, `data_type` and a copy constructor.
+ * @tparam MaxReaders Most Reader handles alive at the same time.
+ */
+template < typename Dict, size_t MaxReaders = 64 >
+class SnapshotDictionary
+{
+    public:
+        //=== Alias
+        typedef typename Dict::key_type key_type;   //!< The key type.
+        typedef typename Dict::data_type data_type; //!< The data type.
+
+    private:
+        /// Where a reader announces the epoch it started reading in (0 while idle).
+        struct alignas( 64 ) Slot {
+            std::atomic< uint64_t > epoch{ 0 }; //!< Epoch of the ongoing read, 0 if none.
+            std::atomic< bool > taken{ false }; //!< Whether a Reader owns the slot.
+        };
+
+        std::atomic< const Dict * > m_current;                      //!< The published snapshot.
+        std::atomic< uint64_t > m_epoch;                             //!< Current epoch (starts at 1).
+        Slot m_slots[MaxReaders];                                    //!< Reader announcements.
+        std::mutex m_write;                                          //!< Serializes writers.
+        std::vector< std::pair< const Dict *, uint64_t > > m_retired; //!< Replaced snapshots and the epoch they were retired in.
+
+        /// Deletes the retired snapshots that no active reader can see. Needs m_write.
+        void reclaim(){
+            uint64_t oldest = UINT64_MAX;
+            for ( const Slot & s : m_slots ) {
+                uint64_t e = s.epoch.load();
+                if ( e != 0 and e < oldest ) oldest = e;
+            }
+            size_t kept = 0;
+            for ( auto & r : m_retired ) {
+                // A reader that announced epoch `oldest` >= r.second started after the swap.
+                if ( oldest >= r.second ) delete r.first;
+                else m_retired[kept++] = r;
+            }
+            m_retired.resize( kept );
+        }
+
+    public:
+        /// A registered reader. Reads are wait-free apart from the work done by Dict itself.
+        class Reader {
+            public:
+                Reader( Reader && other ) noexcept : m_owner{ other.m_owner }, m_slot{ other.m_slot } {
+                    other.m_owner = nullptr;
+                }
+                Reader( const Reader & ) = delete;
+                Reader & operator= ( const Reader & ) = delete;
+                ~Reader(){
+                    if ( m_owner ) m_slot->taken.store( false, std::memory_order_release );
+                }
+
+                /// Calls `f(const Dict &)` on the current snapshot and returns its result.
+                /*!
+                 * The snapshot may only be used inside `f`.
+                 */
+                template < typename F >
+                auto read( F f ) const -> decltype( f( std::declval< const Dict & >() ) ){
+                    Guard guard( *m_slot, m_owner->m_epoch.load() );
+                    return f( *m_owner->m_current.load() );
+                }
+                bool search (const key_type & key, data_type & data) const{
+                    return read( [&]( const Dict & d ) { return d.search( key, data ); } );
+                }
+                key_type min (void) const{ return read( []( const Dict & d ) { return d.min(); } ); }
+                key_type max (void) const{ return read( []( const Dict & d ) { return d.max(); } ); }
+                size_t size (void) const{ return read( []( const Dict & d ) { return d.size(); } ); }
+
+            private:
+                friend class SnapshotDictionary;
+                Reader( const SnapshotDictionary * owner, Slot * slot ) : m_owner{ owner }, m_slot{ slot } { /* empty */ }
+
+                /// Announces an epoch for the duration of a read.
+                struct Guard {
+                    Slot & slot;
+                    Guard( Slot & s, uint64_t e ) : slot( s ) { slot.epoch.store( e ); }
+                    ~Guard() { slot.epoch.store( 0, std::memory_order_release ); }
+                };
+
+                const SnapshotDictionary * m_owner; //!< The dictionary read.
+                Slot * m_slot;                      //!< Slot owned by this reader.
+        };
+
+        //=== special members.
+        /// Publishes an empty dictionary.
+        SnapshotDictionary() : m_current{ new Dict() }, m_epoch{ 1 } { /* empty */ }
+        /// Publishes a copy of `initial`.
+        explicit SnapshotDictionary( const Dict & initial ) : m_current{ new Dict( initial ) }, m_epoch{ 1 } { /* empty */ }
+        /// Destructor; no Reader may be in the middle of a read.
+        ~SnapshotDictionary(){
+            for ( auto & r : m_retired ) delete r.first;
+            delete m_current.load();
+        }
+        SnapshotDictionary( const SnapshotDictionary & ) = delete;
+        SnapshotDictionary & operator= ( const SnapshotDictionary & ) = delete;
+
+        //=== readers
+        /// Registers a reader; throws std::runtime_error if MaxReaders readers are alive.
+        Reader reader(){
+            for ( Slot & s : m_slots ) {
+                if ( not s.taken.load( std::memory_order_relaxed ) and not s.taken.exchange( true, std::memory_order_acquire ) )
+                    return Reader( this, &s );
+            }
+            throw std::runtime_error( "SnapshotDictionary: too many readers" );
+        }
+
+        //=== writers
+        /// Applies `f(Dict &)` to a copy of the current snapshot and publishes the copy.
+        /*!
+         * Each call copies the whole dictionary, so writes should be batched in one call.
+         */
+        template < typename F >
+        void update( F f ){
+            std::lock_guard< std::mutex > lock( m_write );
+            std::unique_ptr< Dict > fresh( new Dict( *m_current.load() ) );
+            f( *fresh );
+            const Dict * old = m_current.exchange( fresh.release() );
+            // Readers that announce this epoch or a later one load the new pointer.
+            m_retired.emplace_back( old, m_epoch.fetch_add( 1 ) + 1 );
+            reclaim();
+        }
+        /// Inserts one entry (a whole update); see Dict::insert().
+        bool insert (const key_type & _newKey, const data_type & _newInfo){
+            bool added = false;
+            update( [&]( Dict & d ) { added = d.insert( _newKey, _newInfo ); } );
+            return added;
+        }
+        /// Removes one entry (a whole update); see Dict::remove().
+        bool remove (const key_type & _newKey, data_type & _newInfo){
+            bool removed = false;
+            update( [&]( Dict & d ) { removed = d.remove( _newKey, _newInfo ); } );
+            return removed;
+        }
+        /// Number of replaced snapshots not yet deleted.
+        size_t retired (void){
+            std::lock_guard< std::mutex > lock( m_write );
+            reclaim();
+            return m_retired.size();
+        }
+};
+
+#endif
@@ -70,8 +70,8 @@ class TestManager {
 //=== MACRO definitions.
 #define RESULT(tm, key, res) tm.result( key, res, __LINE__ )
 #define REGISTER(tm, key, msg) tm.record( key, msg )
-#define EXPECT_TRUE( tm, key, value ) tm.result( key, value==true, __LINE__ )
-#define EXPECT_FALSE( tm, key, value ) tm.result( key, value==false, __LINE__ )
-#define EXPECT_EQUAL( tm, key, value1, value2 ) tm.result( key, value1==value2, __LINE__ )
+#define EXPECT_TRUE( tm, key, value ) tm.result( key, ( value )==true, __LINE__ )
+#define EXPECT_FALSE( tm, key, value ) tm.result( key, ( value )==false, __LINE__ )
+#define EXPECT_EQUAL( tm, key, value1, value2 ) tm.result( key, ( value1 )==( value2 ), __LINE__ )
 
 #endif
@@ -0,0 +1,543 @@
+/**
+ * @file bench_dictionary.cpp
+ * @brief Micro benchmarks for the dictionary classes.
+ *
+ * Every cell of the benchmark is a combination of (container, key type,
+ * access pattern, size). For each cell we build the dictionary by inserting
+ * `size` keys one at a time (and, when the container supports it, with a
+ * single bulk load) and then time search (hit and miss), min/max,
+ * predecessor/successor, a mixed read/write sequence ("mixed") and remove.
+ * Results are printed as CSV (default) or as a JSON array, one record per
+ * (cell, operation).
+ *
+ * Each operation runs at most `--ops` times and is cut short once it spends
+ * more than `--budget-ms`; the `complete` column tells whether the whole
+ * batch ran. A cell whose build phase blows the budget is abandoned, since
+ * the remaining numbers would be meaningless.
+ *
+ * The "Frozen" container is a FrozenDictionary built from a bulk loaded DSAL;
+ * its cells report the time to freeze ("freeze") and the read-only operations.
+ */
+
+#include <iostream>   // cout, cerr, endl
+#include <string>     // std::string
+#include <vector>     // std::vector
+#include <random>     // mt19937_64, distributions
+#include <chrono>     // steady_clock
+#include <algorithm>  // shuffle, sort, min
+#include <cmath>      // pow
+#include <cstdio>     // snprintf
+#include <cstdlib>    // strtoull, strtod
+#include <cstring>    // memset
+#include <cstdint>    // uint64_t
+
+#include "../include/dal.h"
+#include "../include/frozen_dictionary.h"
+#include "../include/dht.h"
+#include "../include/blocked_dictionary.h"
+#include "../include/buffered_dsal.h"
+#include "../include/incremental_dal.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+//=== Helpers
+
+/// Prevents the compiler from optimizing away a value computed in a timed loop.
+template < typename T >
+inline void keep( const T & value )
+{
+    asm volatile( "" : : "r"( &value ) : "memory" );
+}
+
+/// Access patterns used both for the insertion order and for the probes.
+enum class Pattern { uniform, sequential, zipf };
+
+const char * pattern_name( Pattern p )
+{
+    switch ( p ) {
+        case Pattern::uniform:    return "uniform";
+        case Pattern::sequential: return "sequential";
+        default:                  return "zipf";
+    }
+}
+
+/// Turns a numeric id into a key. Present keys use even ids, misses odd ids.
+template < typename T > struct KeyMaker;
+
+template <> struct KeyMaker< int > {
+    static const char * name() { return "int"; }
+    static int make( size_t id ) { return static_cast< int >( id ); }
+};
+
+template <> struct KeyMaker< long long > {
+    static const char * name() { return "int64"; }
+    static long long make( size_t id ) { return static_cast< long long >( id ); }
+};
+
+template <> struct KeyMaker< std::string > {
+    static const char * name() { return "string"; }
+    static std::string make( size_t id ) {
+        char buf[32];
+        std::snprintf( buf, sizeof buf, "key%012llu", static_cast< unsigned long long >( id ) );
+        return buf;
+    }
+};
+
+/// Payload of `N` bytes, to see how the data size affects scans over the keys.
+template < size_t N >
+struct Blob {
+    unsigned char bytes[N];
+    Blob( size_t v = 0 ) { std::memset( bytes, static_cast< int >( v ), N ); }
+};
+
+/// Names the data types in the report.
+template < typename T > struct ValueName;
+template <> struct ValueName< int > { static std::string name() { return "int"; } };
+template < size_t N > struct ValueName< Blob< N > > { static std::string name() { return "blob" + std::to_string( N ); } };
+
+/// Draws ranks in [0,n) with a Zipf-like skew (continuous power-law approximation).
+class ZipfRanks {
+    public:
+        ZipfRanks( size_t n, double s = 0.99 ) : m_n{ n }, m_s{ s }, m_uni{ 0.0, 1.0 }
+        { m_top = std::pow( static_cast< double >( n ) + 1.0, 1.0 - s ) - 1.0; }
+
+        template < typename Gen >
+        size_t operator()( Gen & g ) {
+            double x = std::pow( m_top * m_uni( g ) + 1.0, 1.0 / ( 1.0 - m_s ) ) - 1.0;
+            size_t r = static_cast< size_t >( x );
+            return r < m_n ? r : m_n - 1;
+        }
+
+    private:
+        size_t m_n;
+        double m_s;
+        double m_top;
+        std::uniform_real_distribution< double > m_uni;
+};
+
+/// Command line options.
+struct Options {
+    size_t min_size = 100;
+    size_t max_size = 10000000;
+    size_t ops = 10000;
+    double budget_ms = 2000;
+    uint64_t seed = 42;
+    bool json = false;
+    std::string containers;   //!< Comma separated filter; empty means all.
+    std::string keys;         //!< Comma separated filter; empty means all.
+    std::string patterns;     //!< Comma separated filter; empty means all.
+};
+
+/// Returns true if `name` is listed in the comma separated `filter` (or the filter is empty).
+bool selected( const std::string & filter, const std::string & name )
+{
+    if ( filter.empty() ) return true;
+    size_t begin = 0;
+    while ( begin <= filter.size() ) {
+        size_t end = filter.find( ',', begin );
+        if ( end == std::string::npos ) end = filter.size();
+        if ( filter.compare( begin, end - begin, name ) == 0 ) return true;
+        begin = end + 1;
+    }
+    return false;
+}
+
+//=== Measurement
+
+/// Result of timing one batch of operations.
+struct Sample {
+    size_t ops = 0;
+    double total_ns = 0;
+    double p50_ns = 0;
+    double p99_ns = 0;
+    double max_ns = 0;
+    bool complete = true;
+};
+
+/// Runs `op(j)` for j in [0,count), timing every call, until done or out of budget.
+template < typename Op >
+Sample measure( size_t count, double budget_ms, Op op )
+{
+    Sample s;
+    std::vector< double > lat;
+    lat.reserve( count );
+    const double budget_ns = budget_ms * 1e6;
+    auto start = Clock::now();
+    auto last = start;
+    for ( size_t j = 0; j < count; ++j ) {
+        op( j );
+        auto now = Clock::now();
+        lat.push_back( std::chrono::duration< double, std::nano >( now - last ).count() );
+        last = now;
+        if ( std::chrono::duration< double, std::nano >( now - start ).count() > budget_ns and j + 1 < count ) {
+            s.complete = false;
+            break;
+        }
+    }
+    s.ops = lat.size();
+    s.total_ns = std::chrono::duration< double, std::nano >( last - start ).count();
+    if ( not lat.empty() ) {
+        std::sort( lat.begin(), lat.end() );
+        s.p50_ns = lat[ lat.size() / 2 ];
+        s.p99_ns = lat[ std::min( lat.size() - 1, lat.size() * 99 / 100 ) ];
+        s.max_ns = lat.back();
+    }
+    return s;
+}
+
+/// Prints records as CSV or as a JSON array.
+class Reporter {
+    public:
+        explicit Reporter( bool json ) : m_json{ json }, m_first{ true } {
+            if ( m_json ) std::cout << "[\n";
+            else std::cout << "container,key_type,value_type,pattern,size,op,ops,total_ns,ns_per_op,mops,p50_ns,p99_ns,max_ns,complete\n";
+        }
+        ~Reporter() { if ( m_json ) std::cout << "\n]\n"; }
+
+        void row( const std::string & container, const char * key_type, const std::string & value_type,
+                  Pattern p, size_t size, const char * op, const Sample & s ) {
+            double per_op = s.ops ? s.total_ns / s.ops : 0.0;
+            double mops = s.total_ns > 0 ? s.ops * 1e3 / s.total_ns : 0.0;
+            if ( m_json ) {
+                std::cout << ( m_first ? "  " : ",\n  " )
+                    << "{\"container\":\"" << container << "\",\"key_type\":\"" << key_type
+                    << "\",\"value_type\":\"" << value_type
+                    << "\",\"pattern\":\"" << pattern_name( p ) << "\",\"size\":" << size
+                    << ",\"op\":\"" << op << "\",\"ops\":" << s.ops << ",\"total_ns\":" << s.total_ns
+                    << ",\"ns_per_op\":" << per_op << ",\"mops\":" << mops
+                    << ",\"p50_ns\":" << s.p50_ns << ",\"p99_ns\":" << s.p99_ns
+                    << ",\"max_ns\":" << s.max_ns << ",\"complete\":" << ( s.complete ? "true" : "false" ) << "}";
+            } else {
+                std::cout << container << ',' << key_type << ',' << value_type << ',' << pattern_name( p ) << ',' << size << ','
+                    << op << ',' << s.ops << ',' << s.total_ns << ',' << per_op << ',' << mops << ','
+                    << s.p50_ns << ',' << s.p99_ns << ',' << s.max_ns << ',' << ( s.complete ? 1 : 0 ) << '\n';
+            }
+            m_first = false;
+            std::cout.flush();
+        }
+
+    private:
+        bool m_json;
+        bool m_first;
+};
+
+//=== Workload
+
+/// Keys and probe sequences for one (key type, pattern, size) cell.
+template < typename Key >
+struct Workload {
+    std::vector< Key > inserts; //!< Present keys, in insertion order.
+    std::vector< Key > hits;    //!< Probes for present keys.
+    std::vector< Key > misses;  //!< Probes for absent keys.
+    std::vector< Key > removes; //!< Distinct present keys, in removal order.
+
+    Workload( Pattern p, size_t n, size_t ops, uint64_t seed ) {
+        std::mt19937_64 gen( seed ^ ( n * 0x9E3779B97F4A7C15ULL ) );
+        std::vector< size_t > order( n );
+        for ( size_t i = 0; i < n; ++i ) order[i] = i;
+        if ( p != Pattern::sequential ) std::shuffle( order.begin(), order.end(), gen );
+
+        inserts.reserve( n );
+        for ( size_t i : order ) inserts.push_back( KeyMaker< Key >::make( 2 * i ) );
+
+        // Hot keys for the Zipf pattern are an independent permutation of the key set.
+        std::vector< size_t > hot( order );
+        std::shuffle( hot.begin(), hot.end(), gen );
+        std::uniform_int_distribution< size_t > uni( 0, n - 1 );
+        ZipfRanks zipf( n );
+        hits.reserve( ops );
+        misses.reserve( ops );
+        for ( size_t j = 0; j < ops; ++j ) {
+            size_t i;
+            switch ( p ) {
+                case Pattern::uniform:    i = uni( gen ); break;
+                case Pattern::sequential: i = j % n; break;
+                default:                  i = hot[ zipf( gen ) ]; break;
+            }
+            hits.push_back( KeyMaker< Key >::make( 2 * i ) );
+            misses.push_back( KeyMaker< Key >::make( 2 * i + 1 ) );
+        }
+
+        size_t n_remove = std::min( n, ops );
+        removes.reserve( n_remove );
+        for ( size_t j = 0; j < n_remove; ++j )
+            removes.push_back( KeyMaker< Key >::make( 2 * ( p == Pattern::sequential ? j : hot[ j ] ) ) );
+    }
+};
+
+/// Bulk loads `dict` from [first, last) if it offers `assign`; returns false otherwise.
+template < typename Dict, typename It >
+auto bulk_load( Dict & dict, It first, It last, int ) -> decltype( dict.assign( first, last ), bool() )
+{
+    dict.assign( first, last );
+    return true;
+}
+template < typename Dict, typename It >
+bool bulk_load( Dict &, It, It, long ) { return false; }
+
+/// Bulk loads `dict` on every core if it offers `assign_parallel`; returns false otherwise.
+template < typename Dict, typename It >
+auto bulk_load_parallel( Dict & dict, It first, It last, int ) -> decltype( dict.assign_parallel( first, last ), bool() )
+{
+    dict.assign_parallel( first, last );
+    return true;
+}
+template < typename Dict, typename It >
+bool bulk_load_parallel( Dict &, It, It, long ) { return false; }
+
+/// Looks up [first, last) with one `search_many` call if `dict` offers it; returns false otherwise.
+template < typename Dict, typename It, typename Out >
+auto search_batch( const Dict & dict, It first, It last, Out out, int ) -> decltype( dict.search_many( first, last, out ), bool() )
+{
+    keep( dict.search_many( first, last, out ) );
+    return true;
+}
+template < typename Dict, typename It, typename Out >
+bool search_batch( const Dict &, It, It, Out, long ) { return false; }
+
+/// Times the read-only operations of one cell against an already loaded `dict`.
+template < typename Dict, typename Key, typename Data >
+void run_lookups( Dict & dict, const std::string & name, Pattern p, size_t n, const Workload< Key > & w,
+                  const Options & opt, Reporter & out )
+{
+    const char * kname = KeyMaker< Key >::name();
+    const std::string vname = ValueName< Data >::name();
+    Data data{};
+    Key key{};
+
+    out.row( name, kname, vname, p, n, "search_hit", measure( w.hits.size(), opt.budget_ms, [&]( size_t j ) {
+        keep( dict.search( w.hits[j], data ) ); keep( data );
+    } ) );
+    out.row( name, kname, vname, p, n, "search_miss", measure( w.misses.size(), opt.budget_ms, [&]( size_t j ) {
+        keep( dict.search( w.misses[j], data ) ); keep( data );
+    } ) );
+    {
+        // Batches of hits per search_many call; the row reports per key figures.
+        const size_t batch = 64;
+        std::vector< std::pair< bool, Data > > found;
+        found.reserve( batch );
+        auto into = std::back_inserter( found );
+        if ( w.hits.size() >= batch and search_batch( dict, w.hits.begin(), w.hits.begin(), into, 0 ) ) {
+            Sample s = measure( w.hits.size() / batch, opt.budget_ms, [&]( size_t j ) {
+                found.clear();
+                search_batch( dict, w.hits.begin() + j * batch, w.hits.begin() + ( j + 1 ) * batch, into, 0 );
+                keep( found.back() );
+            } );
+            s.ops *= batch;
+            s.p50_ns /= batch;
+            s.p99_ns /= batch;
+            s.max_ns /= batch;
+            out.row( name, kname, vname, p, n, "search_many", s );
+        }
+    }
+    out.row( name, kname, vname, p, n, "min", measure( opt.ops, opt.budget_ms, [&]( size_t ) {
+        key = dict.min(); keep( key );
+    } ) );
+    out.row( name, kname, vname, p, n, "max", measure( opt.ops, opt.budget_ms, [&]( size_t ) {
+        key = dict.max(); keep( key );
+    } ) );
+    out.row( name, kname, vname, p, n, "predecessor", measure( w.hits.size(), opt.budget_ms, [&]( size_t j ) {
+        keep( dict.predecessor( w.hits[j], key ) ); keep( key );
+    } ) );
+    out.row( name, kname, vname, p, n, "successor", measure( w.hits.size(), opt.budget_ms, [&]( size_t j ) {
+        keep( dict.successor( w.hits[j], key ) ); keep( key );
+    } ) );
+}
+
+/// Runs every operation of one cell against a freshly built `Dict`.
+template < typename Dict, typename Key, typename Data >
+void run_cell( const std::string & name, Pattern p, size_t n, const Options & opt, Reporter & out )
+{
+    const char * kname = KeyMaker< Key >::name();
+    const std::string vname = ValueName< Data >::name();
+    Workload< Key > w( p, n, opt.ops, opt.seed );
+    Dict dict;
+    Data data{};
+
+    {
+        // A single call loads all entries; percentiles repeat the per-entry mean.
+        std::vector< std::pair< Key, Data > > entries;
+        entries.reserve( n );
+        for ( size_t j = 0; j < n; ++j ) entries.emplace_back( w.inserts[j], Data( j ) );
+        Dict loaded;
+        auto start = Clock::now();
+        if ( bulk_load( loaded, entries.begin(), entries.end(), 0 ) ) {
+            Sample b;
+            b.ops = n;
+            b.total_ns = std::chrono::duration< double, std::nano >( Clock::now() - start ).count();
+            b.p50_ns = b.p99_ns = b.max_ns = b.total_ns / n;
+            out.row( name, kname, vname, p, n, "bulk_load", b );
+        }
+        Dict parallel;
+        start = Clock::now();
+        if ( bulk_load_parallel( parallel, entries.begin(), entries.end(), 0 ) ) {
+            Sample b;
+            b.ops = n;
+            b.total_ns = std::chrono::duration< double, std::nano >( Clock::now() - start ).count();
+            b.p50_ns = b.p99_ns = b.max_ns = b.total_ns / n;
+            out.row( name, kname, vname, p, n, "bulk_load_parallel", b );
+        }
+    }
+
+    Sample s = measure( n, opt.budget_ms, [&]( size_t j ) {
+        keep( dict.insert( w.inserts[j], Data( j ) ) );
+    } );
+    out.row( name, kname, vname, p, n, "insert", s );
+    if ( not s.complete ) return;
+
+    run_lookups< Dict, Key, Data >( dict, name, p, n, w, opt, out );
+    // Half reads, half writes: insert an absent key, look up a present one, remove the key inserted
+    // two steps before and look up an absent one, so the size stays around n.
+    out.row( name, kname, vname, p, n, "mixed", measure( w.misses.size(), opt.budget_ms, [&]( size_t j ) {
+        switch ( j % 4 ) {
+            case 0:  keep( dict.insert( w.misses[j], Data( j ) ) ); break;
+            case 1:  keep( dict.search( w.hits[j], data ) ); break;
+            case 2:  keep( dict.remove( w.misses[j - 2], data ) ); break;
+            default: keep( dict.search( w.misses[j], data ) ); break;
+        }
+        keep( data );
+    } ) );
+    out.row( name, kname, vname, p, n, "remove", measure( w.removes.size(), opt.budget_ms, [&]( size_t j ) {
+        keep( dict.remove( w.removes[j], data ) ); keep( data );
+    } ) );
+}
+
+/// Builds a sorted dictionary in one bulk load, freezes it and times the lookups on the frozen copy.
+template < typename Key, typename Data >
+void run_frozen_cell( const std::string & name, Pattern p, size_t n, const Options & opt, Reporter & out )
+{
+    Workload< Key > w( p, n, opt.ops, opt.seed );
+    std::vector< std::pair< Key, Data > > entries;
+    entries.reserve( n );
+    for ( size_t j = 0; j < n; ++j ) entries.emplace_back( w.inserts[j], Data( j ) );
+    DSAL< Key, Data > sorted;
+    sorted.assign( entries.begin(), entries.end() );
+
+    auto start = Clock::now();
+    FrozenDictionary< Key, Data > dict( sorted );
+    Sample f;
+    f.ops = n;
+    f.total_ns = std::chrono::duration< double, std::nano >( Clock::now() - start ).count();
+    f.p50_ns = f.p99_ns = f.max_ns = f.total_ns / n;
+    out.row( name, KeyMaker< Key >::name(), ValueName< Data >::name(), p, n, "freeze", f );
+
+    run_lookups< FrozenDictionary< Key, Data >, Key, Data >( dict, name, p, n, w, opt, out );
+}
+
+/// Calls `cell(p, n)` for all selected patterns and sizes of one container.
+template < typename Key, typename Cell >
+void run_grid( const std::string & name, const Options & opt, Cell cell )
+{
+    if ( not selected( opt.containers, name ) or not selected( opt.keys, KeyMaker< Key >::name() ) )
+        return;
+    const Pattern patterns[] = { Pattern::uniform, Pattern::sequential, Pattern::zipf };
+    for ( Pattern p : patterns ) {
+        if ( not selected( opt.patterns, pattern_name( p ) ) ) continue;
+        for ( size_t n = opt.min_size; n <= opt.max_size; n *= 10 )
+            cell( p, n );
+    }
+}
+
+/// Runs all selected patterns and sizes for one container type.
+template < typename Dict, typename Key, typename Data >
+void run_container( const std::string & name, const Options & opt, Reporter & out )
+{
+    run_grid< Key >( name, opt, [&]( Pattern p, size_t n ) { run_cell< Dict, Key, Data >( name, p, n, opt, out ); } );
+}
+
+/// Runs all selected patterns and sizes for the frozen copy of a DSAL.
+template < typename Key, typename Data >
+void run_frozen( const std::string & name, const Options & opt, Reporter & out )
+{
+    run_grid< Key >( name, opt, [&]( Pattern p, size_t n ) { run_frozen_cell< Key, Data >( name, p, n, opt, out ); } );
+}
+
+/// Runs one container with the SIMD key scans restricted to `isa`, naming it "<name>/<isa>".
+template < typename Dict, typename Key, typename Data >
+void run_container_isa( const std::string & name, dal_simd::Isa isa, const Options & opt, Reporter & out )
+{
+    dal_simd::Isa previous = dal_simd::active_isa();
+    if ( dal_simd::use_isa( isa ) == isa )
+        run_container< Dict, Key, Data >( name + "/" + dal_simd::isa_name( isa ), opt, out );
+    dal_simd::use_isa( previous );
+}
+
+void usage( const char * prog )
+{
+    std::cerr << "Usage: " << prog << " [options]\n"
+              << "  --format=csv|json     output format (default csv)\n"
+              << "  --min-size=N          smallest dictionary size (default 100)\n"
+              << "  --max-size=N          largest dictionary size (default 10000000)\n"
+              << "  --ops=N               operations per measurement (default 10000)\n"
+              << "  --budget-ms=T         time budget per measurement (default 2000)\n"
+              << "  --seed=S              random seed (default 42)\n"
+              << "  --containers=A,B      only run these containers (e.g. DAL,DSAL,Blocked,DHT,Frozen)\n"
+              << "  --keys=A,B            only run these key types (int,int64,string)\n"
+              << "  --patterns=A,B        only run these patterns (uniform,sequential,zipf)\n";
+}
+
+/// Parses `--name=value` style arguments. Returns false on error.
+bool parse( int argc, char * argv[], Options & opt )
+{
+    for ( int i = 1; i < argc; ++i ) {
+        std::string arg{ argv[i] };
+        size_t eq = arg.find( '=' );
+        std::string name = arg.substr( 0, eq );
+        std::string value = eq == std::string::npos ? "" : arg.substr( eq + 1 );
+        if ( name == "--format" ) {
+            if ( value != "csv" and value != "json" ) return false;
+            opt.json = value == "json";
+        }
+        else if ( name == "--min-size" )   opt.min_size = std::strtoull( value.c_str(), nullptr, 10 );
+        else if ( name == "--max-size" )   opt.max_size = std::strtoull( value.c_str(), nullptr, 10 );
+        else if ( name == "--ops" )        opt.ops = std::strtoull( value.c_str(), nullptr, 10 );
+        else if ( name == "--budget-ms" )  opt.budget_ms = std::strtod( value.c_str(), nullptr );
+        else if ( name == "--seed" )       opt.seed = std::strtoull( value.c_str(), nullptr, 10 );
+        else if ( name == "--containers" ) opt.containers = value;
+        else if ( name == "--keys" )       opt.keys = value;
+        else if ( name == "--patterns" )   opt.patterns = value;
+        else return false;
+    }
+    return opt.min_size > 0 and opt.ops > 0;
+}
+
+} // namespace
+
+int main( int argc, char * argv[] )
+{
+    Options opt;
+    if ( not parse( argc, argv, opt ) ) {
+        usage( argv[0] );
+        return EXIT_FAILURE;
+    }
+
+    Reporter out{ opt.json };
+    run_container< DAL< int, int >, int, int >( "DAL", opt, out );
+    run_container< DSAL< int, int >, int, int >( "DSAL", opt, out );
+    run_container< DAL< std::string, int >, std::string, int >( "DAL", opt, out );
+    run_container< IncrementalDAL< int, int >, int, int >( "DAL_incremental", opt, out );
+    run_container< DSAL< std::string, int >, std::string, int >( "DSAL", opt, out );
+    run_container< BufferedDSAL< int, int >, int, int >( "DSAL_buffered", opt, out );
+    run_container< BufferedDSAL< std::string, int >, std::string, int >( "DSAL_buffered", opt, out );
+    run_container< BlockedDictionary< int, int >, int, int >( "Blocked", opt, out );
+    run_container< BlockedDictionary< std::string, int >, std::string, int >( "Blocked", opt, out );
+    run_container< DHT< int, int >, int, int >( "DHT", opt, out );
+    run_container< DHT< std::string, int >, std::string, int >( "DHT", opt, out );
+    // Read-only lookups: binary search on the sorted array against the Eytzinger layout.
+    run_frozen< int, int >( "Frozen", opt, out );
+    run_frozen< std::string, int >( "Frozen", opt, out );
+    // Large values: interleaved pairs against split key/data arrays.
+    typedef Blob< 256 > blob;
+    run_container< DAL< int, blob >, int, blob >( "DAL", opt, out );
+    run_container< DAL< int, blob, std::less< int >, GrowthFactor< 2 >, SplitLayout >, int, blob >( "DAL_split", opt, out );
+    run_container< DSAL< int, blob >, int, blob >( "DSAL", opt, out );
+    run_container< DSAL< int, blob, std::less< int >, GrowthFactor< 2 >, SplitLayout >, int, blob >( "DSAL_split", opt, out );
+    // Unsorted scans over contiguous int64 keys: scalar loop against the SIMD kernels.
+    typedef DAL< long long, int, std::less< long long >, GrowthFactor< 2 >, SplitLayout > dal_split64;
+    const dal_simd::Isa isas[] = { dal_simd::Isa::scalar, dal_simd::Isa::sse2, dal_simd::Isa::avx2 };
+    for ( auto isa : isas )
+        run_container_isa< dal_split64, long long, int >( "DAL_split", isa, opt, out );
+    return EXIT_SUCCESS;
+}
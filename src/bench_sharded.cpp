@@ -0,0 +1,212 @@
+/**
+ * @file bench_sharded.cpp
+ * @brief Multi-threaded benchmark for ShardedDictionary.
+ *
+ * Every thread runs the same mix of operations on a shared dictionary
+ * preloaded with `--size` keys: `--write-pct` percent of the operations are
+ * writes (inserts and removes of random keys, in equal parts) and the rest are
+ * searches. The run is repeated with 1, 2, 4, ... threads up to `--threads`,
+ * and reports the aggregate throughput, as CSV (default) or as a JSON array.
+ *
+ * The "global_mutex" container is the baseline: a single DHT behind one
+ * std::mutex, as used before sharding.
+ */
+
+#include <iostream>   // cout, cerr
+#include <string>     // std::string
+#include <vector>     // std::vector
+#include <random>     // mt19937_64, distributions
+#include <chrono>     // steady_clock
+#include <thread>     // std::thread
+#include <atomic>     // std::atomic
+#include <mutex>      // std::mutex, std::lock_guard
+#include <cstdlib>    // strtoull
+#include <cstdint>    // uint64_t
+
+#include "../include/dal.h"
+#include "../include/dht.h"
+#include "../include/sharded_dictionary.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// Command line options.
+struct Options {
+    size_t threads = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+    size_t size = 100000;
+    size_t ops = 200000;      //!< Operations per thread.
+    size_t write_pct = 10;
+    uint64_t seed = 42;
+    bool json = false;
+    std::string containers;   //!< Comma separated filter; empty means all.
+};
+
+/// Returns true if `name` is listed in the comma separated `filter` (or the filter is empty).
+bool selected( const std::string & filter, const std::string & name )
+{
+    if ( filter.empty() ) return true;
+    size_t begin = 0;
+    while ( begin <= filter.size() ) {
+        size_t end = filter.find( ',', begin );
+        if ( end == std::string::npos ) end = filter.size();
+        if ( filter.compare( begin, end - begin, name ) == 0 ) return true;
+        begin = end + 1;
+    }
+    return false;
+}
+
+/// Baseline: one dictionary behind one mutex.
+template < typename Dict >
+class GlobalMutex {
+    public:
+        bool insert( int key, int data ){
+            std::lock_guard< std::mutex > guard( m_lock );
+            return m_dict.insert( key, data );
+        }
+        bool search( int key, int & data ){
+            std::lock_guard< std::mutex > guard( m_lock );
+            return m_dict.search( key, data );
+        }
+        bool remove( int key, int & data ){
+            std::lock_guard< std::mutex > guard( m_lock );
+            return m_dict.remove( key, data );
+        }
+
+    private:
+        std::mutex m_lock;
+        Dict m_dict;
+};
+
+/// Prints records as CSV or as a JSON array.
+class Reporter {
+    public:
+        explicit Reporter( bool json ) : m_json{ json }, m_first{ true } {
+            if ( m_json ) std::cout << "[\n";
+            else std::cout << "container,threads,write_pct,size,ops,total_ns,mops\n";
+        }
+        ~Reporter() { if ( m_json ) std::cout << "\n]\n"; }
+
+        void row( const std::string & container, size_t threads, const Options & opt, size_t ops, double total_ns ) {
+            double mops = total_ns > 0 ? ops * 1e3 / total_ns : 0.0;
+            if ( m_json ) {
+                std::cout << ( m_first ? "  " : ",\n  " )
+                    << "{\"container\":\"" << container << "\",\"threads\":" << threads
+                    << ",\"write_pct\":" << opt.write_pct << ",\"size\":" << opt.size
+                    << ",\"ops\":" << ops << ",\"total_ns\":" << total_ns << ",\"mops\":" << mops << "}";
+            } else {
+                std::cout << container << ',' << threads << ',' << opt.write_pct << ',' << opt.size << ','
+                    << ops << ',' << total_ns << ',' << mops << '\n';
+            }
+            m_first = false;
+            std::cout.flush();
+        }
+
+    private:
+        bool m_json;
+        bool m_first;
+};
+
+/// Runs the operation mix on `threads` threads against a freshly loaded `Dict`.
+template < typename Dict >
+void run_threads( const std::string & name, size_t threads, const Options & opt, Reporter & out )
+{
+    Dict dict;
+    for ( size_t i = 0; i < opt.size; ++i ) dict.insert( static_cast< int >( 2 * i ), static_cast< int >( i ) );
+
+    std::atomic< size_t > ready{ 0 };
+    std::atomic< bool > go{ false };
+    std::atomic< size_t > found{ 0 };
+    std::vector< std::thread > pool;
+    for ( size_t t = 0; t < threads; ++t ) {
+        pool.emplace_back( [&, t]() {
+            std::mt19937_64 gen( opt.seed + t );
+            std::uniform_int_distribution< int > key( 0, static_cast< int >( 2 * opt.size ) );
+            std::uniform_int_distribution< size_t > pct( 0, 99 );
+            size_t hits = 0;
+            int data = 0;
+            ++ready;
+            while ( not go.load( std::memory_order_acquire ) ) std::this_thread::yield();
+            for ( size_t j = 0; j < opt.ops; ++j ) {
+                int k = key( gen );
+                if ( pct( gen ) < opt.write_pct ) {
+                    if ( j % 2 ) hits += dict.insert( k, k );
+                    else hits += dict.remove( k, data );
+                } else {
+                    hits += dict.search( k, data );
+                }
+            }
+            found += hits;
+        } );
+    }
+    while ( ready.load() < threads ) std::this_thread::yield();
+    auto start = Clock::now();
+    go.store( true, std::memory_order_release );
+    for ( auto & th : pool ) th.join();
+    double total_ns = std::chrono::duration< double, std::nano >( Clock::now() - start ).count();
+    out.row( name, threads, opt, threads * opt.ops, total_ns );
+}
+
+/// Runs one container with 1, 2, 4, ... threads, up to opt.threads.
+template < typename Dict >
+void run_container( const std::string & name, const Options & opt, Reporter & out )
+{
+    if ( not selected( opt.containers, name ) ) return;
+    for ( size_t threads = 1; ; threads *= 2 ) {
+        if ( threads > opt.threads ) threads = opt.threads;
+        run_threads< Dict >( name, threads, opt, out );
+        if ( threads == opt.threads ) break;
+    }
+}
+
+void usage( const char * prog )
+{
+    std::cerr << "Usage: " << prog << " [options]\n"
+              << "  --format=csv|json     output format (default csv)\n"
+              << "  --threads=N           largest number of threads (default: all cores)\n"
+              << "  --size=N              keys loaded before the run (default 100000)\n"
+              << "  --ops=N               operations per thread (default 200000)\n"
+              << "  --write-pct=P         percentage of writes (default 10)\n"
+              << "  --seed=S              random seed (default 42)\n"
+              << "  --containers=A,B      only run these containers (e.g. global_mutex,sharded_DHT)\n";
+}
+
+/// Parses `--name=value` style arguments. Returns false on error.
+bool parse( int argc, char * argv[], Options & opt )
+{
+    for ( int i = 1; i < argc; ++i ) {
+        std::string arg{ argv[i] };
+        size_t eq = arg.find( '=' );
+        std::string name = arg.substr( 0, eq );
+        std::string value = eq == std::string::npos ? "" : arg.substr( eq + 1 );
+        if ( name == "--format" ) {
+            if ( value != "csv" and value != "json" ) return false;
+            opt.json = value == "json";
+        }
+        else if ( name == "--threads" )    opt.threads = std::strtoull( value.c_str(), nullptr, 10 );
+        else if ( name == "--size" )       opt.size = std::strtoull( value.c_str(), nullptr, 10 );
+        else if ( name == "--ops" )        opt.ops = std::strtoull( value.c_str(), nullptr, 10 );
+        else if ( name == "--write-pct" )  opt.write_pct = std::strtoull( value.c_str(), nullptr, 10 );
+        else if ( name == "--seed" )       opt.seed = std::strtoull( value.c_str(), nullptr, 10 );
+        else if ( name == "--containers" ) opt.containers = value;
+        else return false;
+    }
+    return opt.threads > 0 and opt.write_pct <= 100;
+}
+
+} // namespace
+
+int main( int argc, char * argv[] )
+{
+    Options opt;
+    if ( not parse( argc, argv, opt ) ) {
+        usage( argv[0] );
+        return EXIT_FAILURE;
+    }
+
+    Reporter out{ opt.json };
+    run_container< GlobalMutex< DHT< int, int > > >( "global_mutex", opt, out );
+    run_container< ShardedDictionary< DHT< int, int >, 64 > >( "sharded_DHT", opt, out );
+    run_container< ShardedDictionary< DSAL< int, int >, 64 > >( "sharded_DSAL", opt, out );
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,241 @@
+/**
+ * @file bench_snapshot.cpp
+ * @brief Read throughput of SnapshotDictionary under concurrent writers.
+ *
+ * A DSAL with `--size` keys is read by 1, 2, 4, ... threads (up to
+ * `--readers`) for `--duration-ms`, while `--writers` threads keep publishing
+ * batches of `--batch` inserts every `--interval-us` microseconds. Each row
+ * reports the total number of searches and the aggregate read throughput, as
+ * CSV (default) or as a JSON array.
+ *
+ * The "rwlock" container is the baseline: the same DSAL behind one
+ * std::shared_mutex (a ShardedDictionary with a single shard), whose writers
+ * insert under the exclusive lock. "snapshot" is a SnapshotDictionary, whose
+ * writers publish one copy per batch.
+ */
+
+#include <iostream>   // cout, cerr
+#include <string>     // std::string
+#include <vector>     // std::vector
+#include <random>     // mt19937_64, distributions
+#include <chrono>     // steady_clock
+#include <thread>     // std::thread
+#include <atomic>     // std::atomic
+#include <cstdlib>    // strtoull
+#include <cstdint>    // uint64_t
+
+#include "../include/dal.h"
+#include "../include/sharded_dictionary.h"
+#include "../include/snapshot_dictionary.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// Command line options.
+struct Options {
+    size_t readers = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+    size_t writers = 1;
+    size_t size = 100000;
+    size_t batch = 16;
+    size_t interval_us = 1000;
+    size_t duration_ms = 500;
+    uint64_t seed = 42;
+    bool json = false;
+    std::string containers;   //!< Comma separated filter; empty means all.
+};
+
+/// Returns true if `name` is listed in the comma separated `filter` (or the filter is empty).
+bool selected( const std::string & filter, const std::string & name )
+{
+    if ( filter.empty() ) return true;
+    size_t begin = 0;
+    while ( begin <= filter.size() ) {
+        size_t end = filter.find( ',', begin );
+        if ( end == std::string::npos ) end = filter.size();
+        if ( filter.compare( begin, end - begin, name ) == 0 ) return true;
+        begin = end + 1;
+    }
+    return false;
+}
+
+typedef DSAL< int, int > table;
+typedef ShardedDictionary< table, 1 > locked_table;
+typedef SnapshotDictionary< table > snapshot_table;
+
+//=== Per container access
+
+/// What a reader thread searches through.
+locked_table & reader_of( locked_table & dict ) { return dict; }
+snapshot_table::Reader reader_of( snapshot_table & dict ) { return dict.reader(); }
+
+/// Inserts keys [first, first + count) as one write.
+void write_batch( locked_table & dict, int first, size_t count )
+{
+    for ( size_t i = 0; i < count; ++i ) dict.insert( first + static_cast< int >( i ), first );
+}
+void write_batch( snapshot_table & dict, int first, size_t count )
+{
+    dict.update( [&]( table & d ) {
+        for ( size_t i = 0; i < count; ++i ) d.insert( first + static_cast< int >( i ), first );
+    } );
+}
+
+/// Loads the (sorted) entries before the run.
+void load( locked_table & dict, const std::vector< std::pair< int, int > > & entries )
+{
+    for ( const auto & e : entries ) dict.insert( e.first, e.second );
+}
+void load( snapshot_table & dict, const std::vector< std::pair< int, int > > & entries )
+{
+    dict.update( [&]( table & d ) { d.assign( entries.begin(), entries.end() ); } );
+}
+
+/// Prints records as CSV or as a JSON array.
+class Reporter {
+    public:
+        explicit Reporter( bool json ) : m_json{ json }, m_first{ true } {
+            if ( m_json ) std::cout << "[\n";
+            else std::cout << "container,readers,writers,size,reads,writes,total_ns,read_mops\n";
+        }
+        ~Reporter() { if ( m_json ) std::cout << "\n]\n"; }
+
+        void row( const std::string & container, size_t readers, const Options & opt,
+                  size_t reads, size_t writes, double total_ns ) {
+            double mops = total_ns > 0 ? reads * 1e3 / total_ns : 0.0;
+            if ( m_json ) {
+                std::cout << ( m_first ? "  " : ",\n  " )
+                    << "{\"container\":\"" << container << "\",\"readers\":" << readers
+                    << ",\"writers\":" << opt.writers << ",\"size\":" << opt.size
+                    << ",\"reads\":" << reads << ",\"writes\":" << writes
+                    << ",\"total_ns\":" << total_ns << ",\"read_mops\":" << mops << "}";
+            } else {
+                std::cout << container << ',' << readers << ',' << opt.writers << ',' << opt.size << ','
+                    << reads << ',' << writes << ',' << total_ns << ',' << mops << '\n';
+            }
+            m_first = false;
+            std::cout.flush();
+        }
+
+    private:
+        bool m_json;
+        bool m_first;
+};
+
+/// Runs `readers` reader threads and opt.writers writer threads for opt.duration_ms.
+template < typename Dict >
+void run_threads( const std::string & name, size_t readers, const Options & opt, Reporter & out )
+{
+    Dict dict;
+    {
+        std::vector< std::pair< int, int > > entries;
+        entries.reserve( opt.size );
+        for ( size_t i = 0; i < opt.size; ++i ) entries.emplace_back( static_cast< int >( 2 * i ), 0 );
+        load( dict, entries );
+    }
+
+    std::atomic< bool > stop{ false };
+    std::atomic< size_t > reads{ 0 }, writes{ 0 };
+    std::vector< std::thread > pool;
+    for ( size_t t = 0; t < readers; ++t ) {
+        pool.emplace_back( [&, t]() {
+            auto && reader = reader_of( dict );
+            std::mt19937_64 gen( opt.seed + t );
+            std::uniform_int_distribution< int > key( 0, static_cast< int >( 2 * opt.size ) );
+            size_t count = 0;
+            int data = 0;
+            while ( not stop.load( std::memory_order_relaxed ) ) {
+                for ( int j = 0; j < 64; ++j ) reader.search( key( gen ), data );
+                count += 64;
+            }
+            reads += count;
+        } );
+    }
+    for ( size_t w = 0; w < opt.writers; ++w ) {
+        pool.emplace_back( [&, w]() {
+            // Writers add keys above the loaded ones, each in its own range.
+            int next = static_cast< int >( 2 * opt.size + 1 + w * ( 1 << 24 ) );
+            size_t count = 0;
+            while ( not stop.load( std::memory_order_relaxed ) ) {
+                write_batch( dict, next, opt.batch );
+                next += static_cast< int >( opt.batch );
+                ++count;
+                std::this_thread::sleep_for( std::chrono::microseconds( opt.interval_us ) );
+            }
+            writes += count;
+        } );
+    }
+    auto start = Clock::now();
+    std::this_thread::sleep_for( std::chrono::milliseconds( opt.duration_ms ) );
+    stop = true;
+    for ( auto & th : pool ) th.join();
+    double total_ns = std::chrono::duration< double, std::nano >( Clock::now() - start ).count();
+    out.row( name, readers, opt, reads.load(), writes.load(), total_ns );
+}
+
+/// Runs one container with 1, 2, 4, ... readers, up to opt.readers.
+template < typename Dict >
+void run_container( const std::string & name, const Options & opt, Reporter & out )
+{
+    if ( not selected( opt.containers, name ) ) return;
+    for ( size_t readers = 1; ; readers *= 2 ) {
+        if ( readers > opt.readers ) readers = opt.readers;
+        run_threads< Dict >( name, readers, opt, out );
+        if ( readers == opt.readers ) break;
+    }
+}
+
+void usage( const char * prog )
+{
+    std::cerr << "Usage: " << prog << " [options]\n"
+              << "  --format=csv|json     output format (default csv)\n"
+              << "  --readers=N           largest number of reader threads (default: all cores)\n"
+              << "  --writers=N           writer threads (default 1)\n"
+              << "  --size=N              keys loaded before the run (default 100000)\n"
+              << "  --batch=N             inserts per write (default 16)\n"
+              << "  --interval-us=T       pause between writes of a writer (default 1000)\n"
+              << "  --duration-ms=T       length of each run (default 500)\n"
+              << "  --seed=S              random seed (default 42)\n"
+              << "  --containers=A,B      only run these containers (rwlock,snapshot)\n";
+}
+
+/// Parses `--name=value` style arguments. Returns false on error.
+bool parse( int argc, char * argv[], Options & opt )
+{
+    for ( int i = 1; i < argc; ++i ) {
+        std::string arg{ argv[i] };
+        size_t eq = arg.find( '=' );
+        std::string name = arg.substr( 0, eq );
+        std::string value = eq == std::string::npos ? "" : arg.substr( eq + 1 );
+        if ( name == "--format" ) {
+            if ( value != "csv" and value != "json" ) return false;
+            opt.json = value == "json";
+        }
+        else if ( name == "--readers" )     opt.readers = std::strtoull( value.c_str(), nullptr, 10 );
+        else if ( name == "--writers" )     opt.writers = std::strtoull( value.c_str(), nullptr, 10 );
+        else if ( name == "--size" )        opt.size = std::strtoull( value.c_str(), nullptr, 10 );
+        else if ( name == "--batch" )       opt.batch = std::strtoull( value.c_str(), nullptr, 10 );
+        else if ( name == "--interval-us" ) opt.interval_us = std::strtoull( value.c_str(), nullptr, 10 );
+        else if ( name == "--duration-ms" ) opt.duration_ms = std::strtoull( value.c_str(), nullptr, 10 );
+        else if ( name == "--seed" )        opt.seed = std::strtoull( value.c_str(), nullptr, 10 );
+        else if ( name == "--containers" )  opt.containers = value;
+        else return false;
+    }
+    return opt.readers > 0;
+}
+
+} // namespace
+
+int main( int argc, char * argv[] )
+{
+    Options opt;
+    if ( not parse( argc, argv, opt ) ) {
+        usage( argv[0] );
+        return EXIT_FAILURE;
+    }
+
+    Reporter out{ opt.json };
+    run_container< locked_table >( "rwlock", opt, out );
+    run_container< snapshot_table >( "snapshot", opt, out );
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,179 @@
+/**
+ * @file load_dictionary.cpp
+ * @brief Loads a key/value text file into a dictionary and reports the load rate.
+ *
+ * Each line of FILE is `key<separator>value`. The file is loaded with
+ * load_dictionary() into the chosen container and key/value types, and one
+ * record is printed with the rows loaded and rejected, the bytes read, the
+ * wall time and the rows and megabytes per second, as CSV (default) or JSON.
+ *
+ * `--generate=N` writes N random rows of the chosen types to FILE instead,
+ * so the loader can be measured without a real dump.
+ */
+
+#include <iostream>   // cout, cerr
+#include <fstream>    // std::ofstream
+#include <string>     // std::string
+#include <random>     // mt19937_64, distributions
+#include <cstdlib>    // strtoull
+#include <cstdint>    // int64_t, uint64_t
+
+#include "../include/dal.h"
+#include "../include/dht.h"
+#include "../include/blocked_dictionary.h"
+#include "../include/dictionary_loader.h"
+
+namespace {
+
+/// Command line options.
+struct Options {
+    std::string file;
+    std::string container = "DSAL";
+    std::string keys = "int64";
+    std::string values = "int64";
+    char separator = ',';
+    size_t generate = 0;      //!< Rows to write instead of loading; 0 to load.
+    uint64_t seed = 42;
+    bool json = false;
+    LoadOptions load;
+};
+
+/// Writes `rows` random `key<separator>value` lines of the chosen types.
+void generate( const Options & opt )
+{
+    std::ofstream out( opt.file );
+    std::mt19937_64 gen( opt.seed );
+    std::uniform_int_distribution< int64_t > number( 0, static_cast< int64_t >( 4 * opt.generate ) );
+    for ( size_t i = 0; i < opt.generate; ++i ) {
+        int64_t k = number( gen ), v = number( gen );
+        if ( opt.keys == "string" ) out << "key" << k;
+        else out << k;
+        out << opt.separator;
+        if ( opt.values == "string" ) out << "value" << v;
+        else if ( opt.values == "double" ) out << v / 8.0;
+        else out << v;
+        out << '\n';
+    }
+}
+
+/// Loads opt.file into a `Dict` and prints the stats.
+template < typename Dict >
+void run( const Options & opt )
+{
+    Dict dict;
+    DelimitedParser< typename Dict::key_type, typename Dict::data_type > parser;
+    parser.separator = opt.separator;
+    LoadStats s = load_dictionary( opt.file, dict, parser, opt.load );
+    if ( opt.json ) {
+        std::cout << "{\"container\":\"" << opt.container << "\",\"key_type\":\"" << opt.keys
+                  << "\",\"value_type\":\"" << opt.values << "\",\"rows\":" << s.rows
+                  << ",\"rejected\":" << s.rejected << ",\"size\":" << dict.size() << ",\"bytes\":" << s.bytes
+                  << ",\"seconds\":" << s.seconds << ",\"rows_per_s\":" << s.rows_per_second()
+                  << ",\"mb_per_s\":" << s.mb_per_second() << "}\n";
+    } else {
+        std::cout << "container,key_type,value_type,rows,rejected,size,bytes,seconds,rows_per_s,mb_per_s\n"
+                  << opt.container << ',' << opt.keys << ',' << opt.values << ',' << s.rows << ','
+                  << s.rejected << ',' << dict.size() << ',' << s.bytes << ',' << s.seconds << ','
+                  << s.rows_per_second() << ',' << s.mb_per_second() << '\n';
+    }
+}
+
+/// Picks the container for the key and value types `K` and `V`.
+template < typename K, typename V >
+bool run_container( const Options & opt )
+{
+    if ( opt.container == "DSAL" ) run< DSAL< K, V > >( opt );
+    else if ( opt.container == "DAL" ) run< DAL< K, V > >( opt );
+    else if ( opt.container == "DHT" ) run< DHT< K, V > >( opt );
+    else if ( opt.container == "Blocked" ) run< BlockedDictionary< K, V > >( opt );
+    else return false;
+    return true;
+}
+
+/// Picks the value type for the key type `K`.
+template < typename K >
+bool run_values( const Options & opt )
+{
+    if ( opt.values == "int64" ) return run_container< K, int64_t >( opt );
+    if ( opt.values == "double" ) return run_container< K, double >( opt );
+    if ( opt.values == "string" ) return run_container< K, std::string >( opt );
+    return false;
+}
+
+void usage( const char * prog )
+{
+    std::cerr << "Usage: " << prog << " [options] FILE\n"
+              << "  --format=csv|json     output format (default csv)\n"
+              << "  --container=NAME      DSAL, DAL, DHT or Blocked (default DSAL)\n"
+              << "  --keys=TYPE           int64 or string (default int64)\n"
+              << "  --values=TYPE         int64, double or string (default int64)\n"
+              << "  --separator=C         field separator (default ,)\n"
+              << "  --skip-header         ignore the first line\n"
+              << "  --chunk-kb=N          read size in KiB (default 1024)\n"
+              << "  --batch=N             fewest rows per bulk insert (default 65536)\n"
+              << "  --generate=N          write N random rows to FILE instead of loading it\n"
+              << "  --seed=S              random seed for --generate (default 42)\n";
+}
+
+/// Parses `--name=value` style arguments. Returns false on error.
+bool parse( int argc, char * argv[], Options & opt )
+{
+    for ( int i = 1; i < argc; ++i ) {
+        std::string arg{ argv[i] };
+        if ( arg.compare( 0, 2, "--" ) != 0 ) {
+            if ( not opt.file.empty() ) return false;
+            opt.file = arg;
+            continue;
+        }
+        size_t eq = arg.find( '=' );
+        std::string name = arg.substr( 0, eq );
+        std::string value = eq == std::string::npos ? "" : arg.substr( eq + 1 );
+        if ( name == "--format" ) {
+            if ( value != "csv" and value != "json" ) return false;
+            opt.json = value == "json";
+        }
+        else if ( name == "--container" )   opt.container = value;
+        else if ( name == "--keys" )        opt.keys = value;
+        else if ( name == "--values" )      opt.values = value;
+        else if ( name == "--separator" ) {
+            if ( value.size() != 1 ) return false;
+            opt.separator = value[0];
+        }
+        else if ( name == "--skip-header" ) opt.load.skip_header = true;
+        else if ( name == "--chunk-kb" )    opt.load.chunk_bytes = std::strtoull( value.c_str(), nullptr, 10 ) << 10;
+        else if ( name == "--batch" )       opt.load.batch = std::strtoull( value.c_str(), nullptr, 10 );
+        else if ( name == "--generate" )    opt.generate = std::strtoull( value.c_str(), nullptr, 10 );
+        else if ( name == "--seed" )        opt.seed = std::strtoull( value.c_str(), nullptr, 10 );
+        else return false;
+    }
+    return not opt.file.empty() and opt.load.chunk_bytes > 0;
+}
+
+} // namespace
+
+int main( int argc, char * argv[] )
+{
+    Options opt;
+    if ( not parse( argc, argv, opt ) ) {
+        usage( argv[0] );
+        return EXIT_FAILURE;
+    }
+    if ( opt.generate > 0 ) {
+        generate( opt );
+        return EXIT_SUCCESS;
+    }
+
+    try {
+        bool known = false;
+        if ( opt.keys == "int64" ) known = run_values< int64_t >( opt );
+        else if ( opt.keys == "string" ) known = run_values< std::string >( opt );
+        if ( not known ) {
+            usage( argv[0] );
+            return EXIT_FAILURE;
+        }
+    } catch ( std::runtime_error & e ) {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
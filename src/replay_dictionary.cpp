@@ -0,0 +1,251 @@
+/**
+ * @file replay_dictionary.cpp
+ * @brief Replays a recorded trace of dictionary calls against one or more containers.
+ *
+ * FILE is a trace written by TraceWriter or RecordingDictionary (see
+ * dictionary_trace.h). It is read into memory once and replayed from an
+ * empty dictionary on each container in `--container`. For every container
+ * one record per kind of call is printed with its count, its latency
+ * percentiles and the checksum of its results. A final "all" record gives
+ * the throughput of the whole replay. Output is CSV (default) or JSON.
+ * Containers that agree on every result print the same checksums; when
+ * they do not, the first mismatch is reported on stderr.
+ *
+ * `--generate=N` writes a random trace of N calls to FILE instead: half
+ * searches, a quarter inserts, a tenth removes and the rest split among
+ * min, max, predecessor and successor.
+ */
+
+#include <iostream>   // cout, cerr
+#include <string>     // std::string
+#include <vector>     // std::vector
+#include <random>     // mt19937_64, distributions
+#include <cstdio>     // snprintf
+#include <cstdlib>    // strtoull
+#include <cstdint>    // int32_t, int64_t, uint64_t
+#include <initializer_list> // range-for over a braced list
+
+#include "../include/dal.h"
+#include "../include/dht.h"
+#include "../include/blocked_dictionary.h"
+#include "../include/buffered_dsal.h"
+#include "../include/dictionary_trace.h"
+
+namespace {
+
+/// Command line options.
+struct Options {
+    std::string file;
+    std::vector< std::string > containers{ "DSAL" };
+    std::string keys = "int64";
+    std::string values = "int64";
+    size_t generate = 0;      //!< Calls to write instead of replaying; 0 to replay.
+    uint64_t seed = 42;
+    bool latencies = true;
+    bool json = false;
+};
+
+/// Writes `opt.generate` random calls with keys of type `K` and data of type `V`.
+template < typename K, typename V >
+void generate( const Options & opt )
+{
+    TraceWriter< K, V > trace( opt.file );
+    std::mt19937_64 gen( opt.seed );
+    std::uniform_int_distribution< int64_t > key( 0, static_cast< int64_t >( opt.generate ) );
+    std::uniform_int_distribution< int > pick( 0, 99 );
+    for ( size_t i = 0; i < opt.generate; ++i ) {
+        K k = static_cast< K >( key( gen ) );
+        int p = pick( gen );
+        if ( p < 50 ) trace.search( k );
+        else if ( p < 75 ) trace.insert( k, static_cast< V >( i ) );
+        else if ( p < 85 ) trace.remove( k );
+        else if ( p < 88 ) trace.min();
+        else if ( p < 91 ) trace.max();
+        else if ( p < 96 ) trace.predecessor( k );
+        else trace.successor( k );
+    }
+    trace.close();
+}
+
+/// Checksum as 16 hex digits.
+std::string hex( uint64_t value )
+{
+    char text[17];
+    std::snprintf( text, sizeof( text ), "%016llx", static_cast< unsigned long long >( value ) );
+    return text;
+}
+
+/// Prints one record; `ops_per_s` is derived from the mean latency unless given.
+void print( const Options & opt, const std::string & container, const char * op, uint64_t count,
+            double ops_per_s, const LatencyHistogram & h, uint64_t checksum, bool & first )
+{
+    bool e = h.empty();
+    if ( opt.json ) {
+        std::cout << ( first ? "[" : ",\n " ) << "{\"container\":\"" << container << "\",\"op\":\"" << op
+                  << "\",\"count\":" << count << ",\"ops_per_s\":" << ops_per_s << ",\"latency\":";
+        h.write_json( std::cout );
+        std::cout << ",\"checksum\":\"" << hex( checksum ) << "\"}";
+    } else {
+        if ( first ) std::cout << "container,op,count,ops_per_s,mean_ns,p50_ns,p90_ns,p99_ns,p999_ns,max_ns,checksum\n";
+        std::cout << container << ',' << op << ',' << count << ',' << ops_per_s << ',' << h.mean() << ','
+                  << ( e ? 0 : h.percentile( 50 ) ) << ',' << ( e ? 0 : h.percentile( 90 ) ) << ','
+                  << ( e ? 0 : h.percentile( 99 ) ) << ',' << ( e ? 0 : h.percentile( 99.9 ) ) << ','
+                  << ( e ? 0 : h.max() ) << ',' << hex( checksum ) << '\n';
+    }
+    first = false;
+}
+
+/// Replays `events` on an empty `Dict`, prints its records and returns its stats.
+template < typename Dict >
+ReplayStats run( const Options & opt, const std::string & container,
+                 const std::vector< dal_trace::Event< typename Dict::key_type, typename Dict::data_type > > & events, bool & first )
+{
+    Dict dict;
+    ReplayStats s = replay_trace( events, dict, opt.latencies );
+    LatencyHistogram whole;
+    for ( size_t op = 0; op < dal_trace::OPS; ++op ) {
+        if ( s.op_events[op] == 0 ) continue;
+        const LatencyHistogram & h = s.latency[op];
+        whole.merge( h );
+        print( opt, container, dal_trace::op_name( op ), s.op_events[op], h.empty() ? 0.0 : 1e9 / h.mean(), h, s.op_checksum[op], first );
+    }
+    print( opt, container, "all", s.events, s.events_per_second(), whole, s.checksum, first );
+    return s;
+}
+
+/// Replays the trace on every container of `opt.containers`, for keys `K` and data `V`. Returns false on an unknown container.
+template < typename K, typename V >
+bool replay( const Options & opt )
+{
+    std::vector< dal_trace::Event< K, V > > events = read_trace< K, V >( opt.file );
+    bool first = true;
+    std::string reference;
+    ReplayStats expected;
+    for ( const std::string & c : opt.containers ) {
+        ReplayStats s;
+        if ( c == "DSAL" ) s = run< DSAL< K, V > >( opt, c, events, first );
+        else if ( c == "DAL" ) s = run< DAL< K, V > >( opt, c, events, first );
+        else if ( c == "Buffered" ) s = run< BufferedDSAL< K, V > >( opt, c, events, first );
+        else if ( c == "DHT" ) s = run< DHT< K, V > >( opt, c, events, first );
+        else if ( c == "Blocked" ) s = run< BlockedDictionary< K, V > >( opt, c, events, first );
+        else return false;
+        if ( reference.empty() ) {
+            reference = c;
+            expected = s;
+        } else if ( s.checksum != expected.checksum ) {
+            size_t op = 0;
+            while ( op < dal_trace::OPS and s.op_checksum[op] == expected.op_checksum[op] ) ++op;
+            std::cerr << "checksums differ: " << reference << " and " << c << " disagree on "
+                      << dal_trace::op_name( op ) << '\n';
+        }
+    }
+    if ( opt.json and not first ) std::cout << "]\n";
+    return true;
+}
+
+/// Picks the data type for the key type `K`.
+template < typename K >
+bool run_values( const Options & opt )
+{
+    if ( opt.values == "int64" ) {
+        if ( opt.generate > 0 ) generate< K, int64_t >( opt );
+        else return replay< K, int64_t >( opt );
+        return true;
+    }
+    if ( opt.values == "double" ) {
+        if ( opt.generate > 0 ) generate< K, double >( opt );
+        else return replay< K, double >( opt );
+        return true;
+    }
+    return false;
+}
+
+void usage( const char * prog )
+{
+    std::cerr << "Usage: " << prog << " [options] FILE\n"
+              << "  --format=csv|json     output format (default csv)\n"
+              << "  --container=LIST      comma separated: DSAL, DAL, Buffered, DHT, Blocked (default DSAL)\n"
+              << "  --keys=TYPE           int64 or int32, as recorded (default int64)\n"
+              << "  --values=TYPE         int64 or double, as recorded (default int64)\n"
+              << "  --no-latency          time only the whole replay, not each call\n"
+              << "  --generate=N          write a random trace of N calls to FILE instead of replaying it\n"
+              << "  --seed=S              random seed for --generate (default 42)\n";
+}
+
+/// Whether `name` is one of the containers replay() knows.
+bool known_container( const std::string & name )
+{
+    for ( const char * c : { "DSAL", "DAL", "Buffered", "DHT", "Blocked" } )
+        if ( name == c ) return true;
+    return false;
+}
+
+/// Splits `text` at commas.
+std::vector< std::string > split( const std::string & text )
+{
+    std::vector< std::string > parts;
+    size_t begin = 0;
+    while ( true ) {
+        size_t comma = text.find( ',', begin );
+        parts.push_back( text.substr( begin, comma - begin ) );
+        if ( comma == std::string::npos ) return parts;
+        begin = comma + 1;
+    }
+}
+
+/// Parses `--name=value` style arguments. Returns false on error.
+bool parse( int argc, char * argv[], Options & opt )
+{
+    for ( int i = 1; i < argc; ++i ) {
+        std::string arg{ argv[i] };
+        if ( arg.compare( 0, 2, "--" ) != 0 ) {
+            if ( not opt.file.empty() ) return false;
+            opt.file = arg;
+            continue;
+        }
+        size_t eq = arg.find( '=' );
+        std::string name = arg.substr( 0, eq );
+        std::string value = eq == std::string::npos ? "" : arg.substr( eq + 1 );
+        if ( name == "--format" ) {
+            if ( value != "csv" and value != "json" ) return false;
+            opt.json = value == "json";
+        }
+        else if ( name == "--container" ) {
+            // Checked up front, so an unknown name does not cut the output short halfway through.
+            opt.containers = split( value );
+            for ( const std::string & c : opt.containers )
+                if ( not known_container( c ) ) return false;
+        }
+        else if ( name == "--keys" )       opt.keys = value;
+        else if ( name == "--values" )     opt.values = value;
+        else if ( name == "--no-latency" ) opt.latencies = false;
+        else if ( name == "--generate" )   opt.generate = std::strtoull( value.c_str(), nullptr, 10 );
+        else if ( name == "--seed" )       opt.seed = std::strtoull( value.c_str(), nullptr, 10 );
+        else return false;
+    }
+    return not opt.file.empty();
+}
+
+} // namespace
+
+int main( int argc, char * argv[] )
+{
+    Options opt;
+    if ( not parse( argc, argv, opt ) ) {
+        usage( argv[0] );
+        return EXIT_FAILURE;
+    }
+    try {
+        bool known = false;
+        if ( opt.keys == "int64" ) known = run_values< int64_t >( opt );
+        else if ( opt.keys == "int32" ) known = run_values< int32_t >( opt );
+        if ( not known ) {
+            usage( argv[0] );
+            return EXIT_FAILURE;
+        }
+    } catch ( std::runtime_error & e ) {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
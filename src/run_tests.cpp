@@ -7,10 +7,30 @@
 #include <cassert>    // assert()
 #include <random>     // random_device, mt19937
 #include <iterator>   // std::begin(), std::end()
+#include <vector>     // std::vector
+#include <algorithm>  // std::shuffle
+#include <map>        // std::map
+#include <thread>     // std::thread
+#include <atomic>     // std::atomic
+#include <sstream>    // std::ostringstream
 
 
+// The tests check the operation counters, so they are built in (see dal_stats.h).
+#define DAL_STATS 1
+
 #include "../include/test_manager.h"
 #include "../include/dal.h"
+#include "../include/frozen_dictionary.h"
+#include "../include/dht.h"
+#include "../include/blocked_dictionary.h"
+#include "../include/buffered_dsal.h"
+#include "../include/incremental_dal.h"
+#include "../include/sharded_dictionary.h"
+#include "../include/snapshot_dictionary.h"
+#include "../include/mapped_dictionary.h"
+#include "../include/dictionary_loader.h"
+#include "../include/latency_histogram.h"
+#include "../include/dictionary_trace.h"
 
 /**
  * @brief      Class for my key comparator.
@@ -22,6 +42,76 @@ class MyKeyComparator {
         }
 };
 
+/**
+ * @brief      Data type that counts how many instances are alive.
+ */
+struct Counted {
+    static int alive;
+    int value;
+    Counted( int v = 0 ) : value{ v } { ++alive; }
+    Counted( const Counted & other ) : value{ other.value } { ++alive; }
+    Counted & operator=( const Counted & ) = default;
+    ~Counted() { --alive; }
+};
+int Counted::alive = 0;
+
+/**
+ * @brief      Data type that counts how many times it was copied.
+ */
+struct CopyCounted {
+    static int copies;
+    std::vector< int > payload;
+    CopyCounted( int v = 0 ) : payload( 64, v ) { /* empty */ }
+    CopyCounted( const CopyCounted & other ) : payload{ other.payload } { ++copies; }
+    CopyCounted( CopyCounted && other ) = default;
+    CopyCounted & operator=( const CopyCounted & other ) { payload = other.payload; ++copies; return *this; }
+    CopyCounted & operator=( CopyCounted && other ) = default;
+};
+int CopyCounted::copies = 0;
+
+/// A key whose copies throw while `fail` is set, to check that a failed insert leaves the dictionary intact.
+struct ThrowingKey {
+    static bool fail;
+    int value;
+    ThrowingKey( int v = 0 ) : value{ v } { /* empty */ }
+    ThrowingKey( const ThrowingKey & other ) : value{ other.value } { if ( fail ) throw std::runtime_error( "copy" ); }
+    ThrowingKey( ThrowingKey && other ) = default;
+    ThrowingKey & operator=( const ThrowingKey & other ) = default;
+    ThrowingKey & operator=( ThrowingKey && other ) = default;
+    bool operator<( const ThrowingKey & other ) const { return value < other.value; }
+    bool operator==( const ThrowingKey & other ) const { return value == other.value; }
+};
+bool ThrowingKey::fail = false;
+
+/// Compares the SIMD key scans with a plain loop, for every instruction set and many lengths.
+template < typename T >
+bool simd_scan_matches( std::mt19937 & g )
+{
+    std::uniform_int_distribution<int> dist( -50, 50 );
+    const dal_simd::Isa isas[] = { dal_simd::Isa::scalar, dal_simd::Isa::sse2, dal_simd::Isa::avx2 };
+    bool ok{ true };
+    for ( size_t n{1}; n < 80; ++n )
+    {
+        std::vector<T> keys( n );
+        for ( auto & k : keys ) k = static_cast<T>( dist( g ) );
+        T lo{ keys[0] }, hi{ keys[0] };
+        for ( const auto & k : keys ) { if ( k < lo ) lo = k; if ( hi < k ) hi = k; }
+        for ( auto isa : isas )
+        {
+            dal_simd::use_isa( isa );
+            for ( int probe{-52}; probe <= 52; probe += 3 )
+            {
+                T key = static_cast<T>( probe );
+                size_t expected = std::find( keys.begin(), keys.end(), key ) - keys.begin();
+                ok = ok and dal_simd::find_key( keys.data(), n, key ) == expected;
+            }
+            ok = ok and dal_simd::min_key( keys.data(), n ) == lo and dal_simd::max_key( keys.data(), n ) == hi;
+        }
+    }
+    dal_simd::use_isa( dal_simd::Isa::avx2 );
+    return ok;
+}
+
 
 int main ( void )
 {
@@ -311,6 +401,379 @@ int main ( void )
         EXPECT_EQUAL( tm, test_id, key, i );
     }
 
+    {
+        // Testing copy/move semantics, emplace and try_emplace.
+        DAL<int, std::string> dict(2);
+        std::string result;
+
+        auto test_id{ "MoveEmplace" };
+        REGISTER( tm, test_id, "Testing copy/move constructors, rvalue insert, emplace and try_emplace.");
+        std::string key_data( 100, 'a' );
+        EXPECT_TRUE( tm, test_id, dict.insert( 3, std::move( key_data ) ) );
+        EXPECT_TRUE( tm, test_id, key_data.empty() );
+        EXPECT_TRUE( tm, test_id, dict.emplace( 1, 3, 'x' ) );
+        EXPECT_TRUE( tm, test_id, ( dict.search( 1, result ) and result == "xxx" ) );
+        EXPECT_FALSE( tm, test_id, dict.emplace( 1, "yyy" ) );
+        EXPECT_TRUE( tm, test_id, ( dict.search( 1, result ) and result == "yyy" ) );
+        EXPECT_FALSE( tm, test_id, dict.try_emplace( 1, "zzz" ) );
+        EXPECT_TRUE( tm, test_id, ( dict.search( 1, result ) and result == "yyy" ) );
+        EXPECT_TRUE( tm, test_id, dict.try_emplace( 2, "BBB" ) );
+        EXPECT_EQUAL( tm, test_id, dict.size(), 3 );
+
+        DAL<int, std::string> copy( dict );
+        EXPECT_TRUE( tm, test_id, ( copy.remove( 2, result ) and result == "BBB" ) );
+        EXPECT_EQUAL( tm, test_id, dict.size(), 3 );
+        EXPECT_EQUAL( tm, test_id, copy.size(), 2 );
+
+        DAL<int, std::string> moved( std::move( dict ) );
+        EXPECT_EQUAL( tm, test_id, moved.size(), 3 );
+        EXPECT_TRUE( tm, test_id, dict.empty() );
+        EXPECT_TRUE( tm, test_id, ( moved.search( 3, result ) and result == std::string( 100, 'a' ) ) );
+        // A moved-from dictionary can be reused.
+        EXPECT_TRUE( tm, test_id, dict.insert( 9, "III" ) );
+        EXPECT_TRUE( tm, test_id, ( dict.search( 9, result ) and result == "III" ) );
+
+        copy = moved;
+        EXPECT_EQUAL( tm, test_id, copy.size(), 3 );
+        copy = std::move( dict );
+        EXPECT_EQUAL( tm, test_id, copy.size(), 1 );
+        EXPECT_EQUAL( tm, test_id, copy.min(), 9 );
+    }
+
+    {
+        // Testing raw storage, reserve/shrink_to_fit and the growth policy.
+        auto test_id{ "StorageGrowth" };
+        REGISTER( tm, test_id, "Testing that only live entries are constructed, reserve, shrink_to_fit and growth policy.");
+        {
+            DAL<int, Counted> dict( 1000 );
+            // No entry may be constructed for unused capacity.
+            EXPECT_EQUAL( tm, test_id, Counted::alive, 0 );
+            for ( int i{0}; i < 10; ++i ) dict.insert( i, Counted( i ) );
+            EXPECT_EQUAL( tm, test_id, Counted::alive, 10 );
+            Counted c;
+            EXPECT_TRUE( tm, test_id, ( dict.remove( 3, c ) and c.value == 3 ) );
+            EXPECT_EQUAL( tm, test_id, Counted::alive, 10 );
+            dict.shrink_to_fit();
+            EXPECT_EQUAL( tm, test_id, dict.capacity(), 9 );
+            EXPECT_TRUE( tm, test_id, ( dict.search( 9, c ) and c.value == 9 ) );
+            dict.reserve( 100 );
+            EXPECT_EQUAL( tm, test_id, dict.capacity(), 100 );
+            dict.reserve( 10 );
+            EXPECT_EQUAL( tm, test_id, dict.capacity(), 100 );
+        }
+        EXPECT_EQUAL( tm, test_id, Counted::alive, 0 );
+
+        DAL<int, int, std::less<int>, GrowthFactor<3, 2> > dict( 4 );
+        for ( int i{0}; i < 5; ++i ) dict.insert( i, i );
+        EXPECT_EQUAL( tm, test_id, dict.capacity(), 6 );
+        DSAL<int, int, std::less<int>, GrowthFactor<4> > sorted( 0 );
+        for ( int i{5}; i > 0; --i ) sorted.insert( i, i );
+        EXPECT_EQUAL( tm, test_id, sorted.capacity(), 16 );
+        EXPECT_EQUAL( tm, test_id, sorted.min(), 1 );
+    }
+
+    {
+        // Testing the split (structure of arrays) layout.
+        typedef DAL<int, std::string, std::less<int>, GrowthFactor<2>, SplitLayout> split_dict;
+        split_dict dict(2);
+        std::string result;
+
+        auto test_id{ "SplitLayout" };
+        REGISTER( tm, test_id, "Testing the dictionary with keys and data stored in separate arrays.");
+        const int keys[] = { 5, 3, 9, 1, 7 };
+        for ( int k : keys ) EXPECT_TRUE( tm, test_id, dict.insert( k, std::to_string( k ) ) );
+        EXPECT_FALSE( tm, test_id, dict.insert( 3, "three" ) );
+        EXPECT_EQUAL( tm, test_id, dict.size(), 5 );
+        EXPECT_EQUAL( tm, test_id, dict.min(), 1 );
+        EXPECT_EQUAL( tm, test_id, dict.max(), 9 );
+        EXPECT_TRUE( tm, test_id, ( dict.search( 3, result ) and result == "three" ) );
+        EXPECT_TRUE( tm, test_id, ( dict.remove( 5, result ) and result == "5" ) );
+        EXPECT_FALSE( tm, test_id, dict.search( 5, result ) );
+        EXPECT_TRUE( tm, test_id, ( dict.search( 7, result ) and result == "7" ) );
+
+        split_dict copy( dict );
+        EXPECT_TRUE( tm, test_id, ( copy.remove( 1, result ) and result == "1" ) );
+        EXPECT_EQUAL( tm, test_id, dict.min(), 1 );
+        EXPECT_EQUAL( tm, test_id, copy.min(), 3 );
+        dict.shrink_to_fit();
+        EXPECT_EQUAL( tm, test_id, dict.capacity(), 4 );
+        EXPECT_TRUE( tm, test_id, ( dict.search( 9, result ) and result == "9" ) );
+    }
+
+    {
+        // Testing the SIMD key scans.
+        auto test_id{ "SimdScan" };
+        REGISTER( tm, test_id, "Testing the vectorized search/min/max against the scalar loops.");
+        std::random_device rd;
+        std::mt19937 g(rd());
+        EXPECT_TRUE( tm, test_id, simd_scan_matches<int>( g ) );
+        EXPECT_TRUE( tm, test_id, simd_scan_matches<long long>( g ) );
+        EXPECT_TRUE( tm, test_id, simd_scan_matches<float>( g ) );
+        EXPECT_TRUE( tm, test_id, simd_scan_matches<double>( g ) );
+
+        typedef DAL<long long, int, std::less<long long>, GrowthFactor<2>, SplitLayout> split_dict;
+        split_dict dict;
+        int result{0};
+        for ( long long k{0}; k < 1000; ++k ) dict.insert( ( k * 7919 ) % 1000 - 500, static_cast<int>( k ) );
+        EXPECT_EQUAL( tm, test_id, dict.min(), -500 );
+        EXPECT_EQUAL( tm, test_id, dict.max(), 499 );
+        EXPECT_TRUE( tm, test_id, ( dict.search( 7919 % 1000 - 500, result ) and result == 1 ) );
+        EXPECT_FALSE( tm, test_id, dict.search( 500, result ) );
+        EXPECT_TRUE( tm, test_id, ( dict.remove( -500, result ) and result == 0 ) );
+        EXPECT_EQUAL( tm, test_id, dict.min(), -499 );
+    }
+
+    {
+        // Testing batched lookups against one search per key.
+        DAL<int, int> dict;
+        for ( int k = 0; k < 100; ++k ) dict.insert( 3 * k, k );
+        std::vector< int > keys;
+        for ( int k = 0; k < 40; ++k ) keys.push_back( ( k * 37 ) % 320 );
+        keys.push_back( keys.front() );   // Repeated key.
+        std::vector< std::pair< bool, int > > result;
+        size_t found = dict.search_many( keys.begin(), keys.end(), std::back_inserter( result ) );
+
+        bool same{ result.size() == keys.size() };
+        size_t expected{ 0 };
+        for ( size_t i = 0; same and i < keys.size(); ++i ) {
+            int data{ -1 };
+            bool hit = dict.search( keys[i], data );
+            expected += hit;
+            same = result[i].first == hit and ( not hit or result[i].second == data );
+        }
+
+        auto test_id{ "SearchMany" };
+        REGISTER( tm, test_id, "Testing that search_many matches one search per key.");
+        EXPECT_TRUE( tm, test_id, same );
+        EXPECT_EQUAL( tm, test_id, found, expected );
+        // Small batches are searched one key at a time.
+        result.clear();
+        EXPECT_EQUAL( tm, test_id, dict.search_many( keys.begin(), keys.begin() + 2, std::back_inserter( result ) ), 1 );
+        EXPECT_TRUE( tm, test_id, result.size() == 2 and result[0].first and result[0].second == 0 and not result[1].first );
+        DAL<int, int> empty;
+        result.clear();
+        EXPECT_EQUAL( tm, test_id, empty.search_many( keys.begin(), keys.end(), std::back_inserter( result ) ), 0 );
+        EXPECT_EQUAL( tm, test_id, result.size(), keys.size() );
+    }
+
+    {
+        // Testing quickselect against a sorted copy of the keys.
+        DAL<int, int> dict;
+        std::vector< int > sorted;
+        std::mt19937 g( 7 );
+        for ( int k = 0; k < 300; ++k ) {
+            int key = static_cast< int >( g() % 10000 ) - 5000;
+            if ( dict.insert( key, k ) ) sorted.push_back( key );
+        }
+        std::sort( sorted.begin(), sorted.end() );
+        bool same{ true };
+        for ( size_t k = 0; k < sorted.size(); ++k ) same = same and dict.select( k ) == sorted[k];
+
+        auto test_id{ "OrderStatistics" };
+        REGISTER( tm, test_id, "Testing select and percentile.");
+        EXPECT_TRUE( tm, test_id, same );
+        EXPECT_EQUAL( tm, test_id, dict.percentile( 0 ), sorted.front() );
+        EXPECT_EQUAL( tm, test_id, dict.percentile( 50 ), sorted[ ( sorted.size() + 1 ) / 2 - 1 ] );
+        EXPECT_EQUAL( tm, test_id, dict.percentile( 100 ), sorted.back() );
+        bool worked{ false };
+        try {
+            dict.select( sorted.size() );
+        }
+        catch ( std::out_of_range & e )
+        {
+            worked = true;
+        }
+        EXPECT_TRUE( tm, test_id, worked );
+        worked = false;
+        try {
+            dict.percentile( 101 );
+        }
+        catch ( std::out_of_range & e )
+        {
+            worked = true;
+        }
+        EXPECT_TRUE( tm, test_id, worked );
+    }
+
+    {
+        // Testing the cached min/max and the single pass predecessor/successor against std::map.
+        DAL<int, int> dict;
+        std::map<int, int> reference;
+        std::mt19937 g( 11 );
+        bool same{ true };
+        int key{ 0 }, data{ 0 };
+        for ( int step = 0; step < 2000; ++step ) {
+            int k = static_cast< int >( g() % 200 );
+            if ( g() % 3 == 0 ) {
+                same = same and dict.remove( k, data ) == ( reference.erase( k ) == 1 );
+            } else {
+                dict.insert( k, step );
+                reference[k] = step;
+            }
+            if ( reference.empty() ) continue;
+            same = same and dict.min() == reference.begin()->first and dict.max() == reference.rbegin()->first;
+            int x = static_cast< int >( g() % 210 ) - 5;
+            auto lo = reference.lower_bound( x );
+            auto hi = reference.upper_bound( x );
+            bool has_pred = lo != reference.begin();
+            same = same and dict.predecessor( x, key ) == has_pred and ( not has_pred or key == std::prev( lo )->first );
+            bool has_succ = hi != reference.end();
+            same = same and dict.successor( x, key ) == has_succ and ( not has_succ or key == hi->first );
+        }
+
+        auto test_id{ "CachedExtremes" };
+        REGISTER( tm, test_id, "Testing min/max and predecessor/successor under random inserts and removes.");
+        EXPECT_TRUE( tm, test_id, same );
+        // Copies and swaps carry the cache along.
+        DAL<int, int> copy( dict ), other;
+        other.insert( -1, 0 );
+        other.min();
+        copy.swap( other );
+        EXPECT_EQUAL( tm, test_id, copy.min(), -1 );
+        EXPECT_EQUAL( tm, test_id, other.max(), reference.rbegin()->first );
+    }
+
+    {
+        // Testing the lookups that hand out pointers and move data out.
+        DAL<int, CopyCounted> dict;
+        for ( int k = 0; k < 10; ++k ) dict.emplace( k, k );
+        CopyCounted::copies = 0;
+
+        auto test_id{ "ZeroCopy" };
+        REGISTER( tm, test_id, "Testing find, contains and extract.");
+        const DAL<int, CopyCounted> & view = dict;
+        EXPECT_TRUE( tm, test_id, ( view.find( 4 ) != nullptr and view.find( 4 )->payload[0] == 4 ) );
+        EXPECT_TRUE( tm, test_id, ( view.find( 40 ) == nullptr ) );
+        EXPECT_TRUE( tm, test_id, dict.contains( 9 ) );
+        EXPECT_FALSE( tm, test_id, dict.contains( -1 ) );
+        dict.find( 5 )->payload[0] = 50;
+        CopyCounted out;
+        EXPECT_TRUE( tm, test_id, ( dict.extract( 5, out ) and out.payload[0] == 50 ) );
+        EXPECT_FALSE( tm, test_id, dict.contains( 5 ) );
+        EXPECT_FALSE( tm, test_id, dict.extract( 5, out ) );
+        EXPECT_TRUE( tm, test_id, ( dict.remove( 0, out ) and out.payload[0] == 0 ) );
+        EXPECT_EQUAL( tm, test_id, dict.size(), 8 );
+        EXPECT_EQUAL( tm, test_id, CopyCounted::copies, 0 );
+    }
+
+    {
+        // Testing the operation counters against hand counted scans.
+        DAL<int, int> dict( 4 );
+        for ( int k = 0; k < 5; ++k ) dict.insert( k, k );
+
+        auto test_id{ "Stats" };
+        REGISTER( tm, test_id, "Testing the operation counters and reset_stats.");
+        EXPECT_TRUE( tm, test_id, ( DAL<int, int>::stats_enabled ) );
+        DictionaryStats s = dict.stats();
+        EXPECT_EQUAL( tm, test_id, s.inserts, 5 );
+        EXPECT_EQUAL( tm, test_id, s.comparisons, 0 + 1 + 2 + 3 + 4 ); // Every insert scans the whole array.
+        EXPECT_EQUAL( tm, test_id, s.resizes, 1 );                     // 4 -> 8 on the fifth insert.
+        EXPECT_EQUAL( tm, test_id, s.moves, 4 );
+        EXPECT_EQUAL( tm, test_id, s.bytes_allocated, ( 4 + 8 ) * sizeof( std::pair<int, int> ) );
+        EXPECT_EQUAL( tm, test_id, s.bytes_moved, 4 * sizeof( std::pair<int, int> ) );
+
+        dict.reset_stats();
+        int data{ 0 };
+        dict.insert( 2, 20 );          // 3 comparisons, an update.
+        dict.search( 4, data );        // 5, a hit.
+        dict.contains( 9 );            // 5, a miss.
+        dict.remove( 0, data );        // 1, the last entry moves into slot 0.
+        dict.extract( 0, data );       // 4, a miss.
+        s = dict.stats();
+        EXPECT_EQUAL( tm, test_id, s.comparisons, 18 );
+        EXPECT_EQUAL( tm, test_id, s.updates, 1 );
+        EXPECT_EQUAL( tm, test_id, s.inserts, 0 );
+        EXPECT_EQUAL( tm, test_id, s.lookup_hits, 1 );
+        EXPECT_EQUAL( tm, test_id, s.lookup_misses, 1 );
+        EXPECT_EQUAL( tm, test_id, s.remove_hits, 1 );
+        EXPECT_EQUAL( tm, test_id, s.remove_misses, 1 );
+        EXPECT_EQUAL( tm, test_id, s.moves, 1 );
+        EXPECT_EQUAL( tm, test_id, s.resizes, 0 );
+
+        // A copy counts only its own work.
+        DAL<int, int> copy( dict );
+        EXPECT_EQUAL( tm, test_id, copy.stats().comparisons, 0 );
+        EXPECT_EQUAL( tm, test_id, copy.stats().bytes_allocated, 8 * sizeof( std::pair<int, int> ) );
+    }
+
+    {
+        // Testing the incremental growth against std::map, with migrations running most of the time.
+        IncrementalDAL<int, int> dict( 2, 1 );
+        IncrementalDAL<int, int, std::less<int>, GrowthFactor<3, 2>, SplitLayout> split( 1, 1 );
+        std::map<int, int> reference;
+        std::mt19937 g( 13 );
+        bool same{ true }, bounded{ true }, migrated{ false };
+        int key{ 0 }, data{ 0 };
+        for ( int step = 0; step < 4000; ++step ) {
+            int k = static_cast< int >( g() % 1000 );
+            uint64_t moves = dict.stats().moves;
+            if ( g() % 4 == 0 ) {
+                bool had = reference.erase( k ) == 1;
+                same = same and dict.remove( k, data ) == had and split.remove( k, data ) == had;
+            } else {
+                bool added = reference.insert( std::make_pair( k, step ) ).second;
+                reference[k] = step;
+                same = same and dict.insert( k, step ) == added and split.insert( k, step ) == added;
+            }
+            // A call moves at most one step of the migration, plus the entry that fills a removed slot.
+            bounded = bounded and dict.stats().moves - moves <= dict.migration_step() + 1;
+            migrated = migrated or dict.migrating();
+            same = same and dict.size() == reference.size() and split.size() == reference.size();
+            int x = static_cast< int >( g() % 1010 ) - 5;
+            auto it = reference.find( x );
+            same = same and dict.search( x, data ) == ( it != reference.end() ) and ( it == reference.end() or data == it->second );
+            same = same and split.contains( x ) == ( it != reference.end() );
+            if ( reference.empty() ) continue;
+            same = same and dict.min() == reference.begin()->first and split.max() == reference.rbegin()->first;
+            auto lo = reference.lower_bound( x );
+            bool has_pred = lo != reference.begin();
+            same = same and dict.predecessor( x, key ) == has_pred and ( not has_pred or key == std::prev( lo )->first );
+            auto hi = reference.upper_bound( x );
+            bool has_succ = hi != reference.end();
+            same = same and split.successor( x, key ) == has_succ and ( not has_succ or key == hi->first );
+        }
+
+        auto test_id{ "IncrementalGrowth" };
+        REGISTER( tm, test_id, "Testing that growth is spread over later calls and lookups read both arrays.");
+        EXPECT_TRUE( tm, test_id, same );
+        EXPECT_TRUE( tm, test_id, bounded );
+        EXPECT_TRUE( tm, test_id, migrated );
+        // GrowthFactor<3, 2> leaves room for half the entries, so two must move per call.
+        IncrementalDAL<int, int, std::less<int>, GrowthFactor<3, 2> > slow( 8, 1 );
+        for ( int k = 0; k < 9; ++k ) slow.insert( k, k );
+        EXPECT_EQUAL( tm, test_id, slow.migration_step(), 2 );
+
+        // Fill the array and start a migration, then copy, select and finish it.
+        IncrementalDAL<int, int> fresh( 8, 1 );
+        for ( int k = 0; k < 9; ++k ) fresh.insert( k, k );
+        EXPECT_TRUE( tm, test_id, fresh.migrating() );
+        EXPECT_EQUAL( tm, test_id, fresh.capacity(), 16 );
+        // A DAL reference would only see the new array, so none can be taken; keys still in the old one are found and kept unique.
+        static_assert( not std::is_convertible< IncrementalDAL<int, int> *, DAL<int, int> * >::value,
+                       "IncrementalDAL must not be usable as a plain DAL." );
+        EXPECT_FALSE( tm, test_id, fresh.emplace( 0, 10 ) );
+        EXPECT_FALSE( tm, test_id, fresh.try_emplace( 1, 11 ) );
+        EXPECT_TRUE( tm, test_id, fresh.migrating() );
+        EXPECT_EQUAL( tm, test_id, fresh.size(), 9 );
+        EXPECT_TRUE( tm, test_id, ( fresh.search( 0, data ) and data == 10 ) );
+        EXPECT_TRUE( tm, test_id, fresh.remove( 0, data ) and data == 10 and not fresh.contains( 0 ) );
+        EXPECT_TRUE( tm, test_id, ( fresh.insert( 0, 0 ) and fresh.search( 1, data ) and data == 1 ) );
+        IncrementalDAL<int, int> copy( fresh );
+        EXPECT_FALSE( tm, test_id, copy.migrating() );
+        EXPECT_EQUAL( tm, test_id, copy.size(), 9 );
+        EXPECT_TRUE( tm, test_id, ( copy.search( 0, data ) and data == 0 ) );
+        EXPECT_EQUAL( tm, test_id, fresh.select( 4 ), 4 );
+        EXPECT_EQUAL( tm, test_id, fresh.percentile( 100 ), 8 );
+        std::vector<int> keys{ 0, 3, 8, 20 };
+        std::vector< std::pair<bool, int> > found;
+        EXPECT_EQUAL( tm, test_id, fresh.search_many( keys.begin(), keys.end(), std::back_inserter( found ) ), 3 );
+        fresh.shrink_to_fit();
+        EXPECT_FALSE( tm, test_id, fresh.migrating() );
+        EXPECT_EQUAL( tm, test_id, fresh.capacity(), 9 );
+        copy = std::move( fresh );
+        EXPECT_TRUE( tm, test_id, copy.contains( 8 ) and fresh.empty() );
+    }
+
     // Creates a test manager for the DSAL class.
     TestManager tm2{ "DSAL<int, string> Suite" };
 
@@ -593,8 +1056,1132 @@ int main ( void )
         EXPECT_EQUAL( tm2, test_id, key, i );
     }
 
+    {
+        // Testing sorted insertion with many keys.
+        DSAL<int, int> dict(4);
+        int result{0};
+        // Pairs of trivially copyable types shift with one memmove; others element by element.
+        static_assert( dal_detail::trivially_relocatable< std::pair<int, int> >::value, "DSAL<int, int> must shift with memmove." );
+        static_assert( not dal_detail::trivially_relocatable< std::pair<int, std::string> >::value, "Strings must be moved one by one." );
+
+        std::vector<int> keys( 500 );
+        for ( size_t i{0}; i < keys.size(); ++i ) keys[i] = static_cast<int>( 2 * i + 1 );
+        std::random_device rd;
+        std::mt19937 g(rd());
+        std::shuffle( keys.begin(), keys.end(), g);
+
+        auto test_id{ "InsertKeepsOrder" };
+        REGISTER( tm2, test_id, "Testing that insertions in random order keep the keys sorted.");
+        for ( const auto & k : keys )
+        {
+            EXPECT_TRUE( tm2, test_id, dict.insert( k, k * 10 ) ) ;
+        }
+        EXPECT_EQUAL( tm2, test_id, dict.size(), keys.size() );
+        EXPECT_FALSE( tm2, test_id, dict.insert( 7, 0 ) );
+        EXPECT_TRUE( tm2, test_id, ( dict.search( 7, result ) and result == 0 ) );
+
+        auto key { dict.min() };
+        int next_key{0};
+        int i{1};
+        while( dict.successor( key, next_key ) )
+        {
+            EXPECT_EQUAL( tm2, test_id, key, i );
+            i += 2;
+            key = next_key;
+        }
+        EXPECT_EQUAL( tm2, test_id, key, 999 );
+
+        // Keys outside and in between the stored ones must not be found.
+        EXPECT_FALSE( tm2, test_id, dict.search( 0, result ) );
+        EXPECT_FALSE( tm2, test_id, dict.search( -5, result ) );
+        EXPECT_FALSE( tm2, test_id, dict.search( 500, result ) );
+        EXPECT_FALSE( tm2, test_id, dict.search( 1000, result ) );
+    }
+
+    {
+        // Testing that an insert whose key copy throws leaves the sorted array intact.
+        DSAL<ThrowingKey, int> dict;
+        for ( int k = 1; k <= 5; ++k ) dict.insert( ThrowingKey( 2 * k ), k );
+        ThrowingKey middle( 5 );
+        bool threw{ false };
+        ThrowingKey::fail = true;
+        try {
+            dict.insert( middle, 0 );
+        }
+        catch ( std::runtime_error & e )
+        {
+            threw = true;
+        }
+        ThrowingKey::fail = false;
+        int result{ 0 };
+        bool intact{ dict.size() == 5 };
+        for ( int k = 1; k <= 5; ++k ) intact = intact and dict.search( ThrowingKey( 2 * k ), result ) and result == k;
+
+        auto test_id{ "InsertThrows" };
+        REGISTER( tm2, test_id, "Testing that a throwing key copy leaves no hole in the array.");
+        EXPECT_TRUE( tm2, test_id, threw );
+        EXPECT_TRUE( tm2, test_id, intact );
+        EXPECT_FALSE( tm2, test_id, dict.contains( middle ) );
+        EXPECT_TRUE( tm2, test_id, ( dict.insert( middle, 9 ) and dict.size() == 6 ) );
+        EXPECT_EQUAL( tm2, test_id, dict.select( 2 ).value, 5 );
+    }
+
+    {
+        // Testing bulk construction and batch insertion.
+        std::vector< std::pair<int, std::string> > table
+        {
+            { 4, "DDD" }, { 1, "AAA" }, { 3, "CCC" }, { 1, "aaa" }, { 2, "BBB" }
+        };
+        std::string result;
+
+        auto test_id{ "BulkLoad" };
+        REGISTER( tm2, test_id, "Testing the range constructor and insert_range.");
+        DSAL<int, std::string> dict( table.begin(), table.end() );
+        EXPECT_EQUAL( tm2, test_id, dict.size(), 4 );
+        EXPECT_EQUAL( tm2, test_id, dict.min(), 1 );
+        EXPECT_EQUAL( tm2, test_id, dict.max(), 4 );
+        // Last writer wins for duplicated keys.
+        EXPECT_TRUE( tm2, test_id, ( dict.search( 1, result ) and result == "aaa" ) );
+
+        std::vector< std::pair<int, std::string> > batch
+        {
+            { 6, "FFF" }, { 0, "000" }, { 3, "ccc" }, { 5, "EEE" }, { 6, "fff" }
+        };
+        EXPECT_EQUAL( tm2, test_id, dict.insert_range( batch.begin(), batch.end() ), 3 );
+        EXPECT_EQUAL( tm2, test_id, dict.size(), 7 );
+        EXPECT_TRUE( tm2, test_id, ( dict.search( 3, result ) and result == "ccc" ) );
+        EXPECT_TRUE( tm2, test_id, ( dict.search( 6, result ) and result == "fff" ) );
+        int key{ dict.min() }, next_key{0}, i{0};
+        while( dict.successor( key, next_key ) )
+        {
+            EXPECT_EQUAL( tm2, test_id, key, i++ );
+            key = next_key;
+        }
+        EXPECT_EQUAL( tm2, test_id, key, 6 );
+
+        // Regular inserts still work after a bulk load.
+        EXPECT_TRUE( tm2, test_id, dict.insert( 7, "GGG" ) );
+        dict.assign( batch.begin(), batch.begin() + 2 );
+        EXPECT_EQUAL( tm2, test_id, dict.size(), 2 );
+        EXPECT_FALSE( tm2, test_id, dict.search( 1, result ) );
+    }
+
+    {
+        // Testing copy/move semantics, emplace and try_emplace.
+        DSAL<int, std::string> dict(2);
+        std::string result;
+
+        auto test_id{ "MoveEmplace" };
+        REGISTER( tm2, test_id, "Testing copy/move constructors, rvalue insert, emplace and try_emplace.");
+        std::string key_data( 100, 'a' );
+        EXPECT_TRUE( tm2, test_id, dict.insert( 3, std::move( key_data ) ) );
+        EXPECT_TRUE( tm2, test_id, key_data.empty() );
+        EXPECT_TRUE( tm2, test_id, dict.emplace( 1, 3, 'x' ) );
+        EXPECT_TRUE( tm2, test_id, ( dict.search( 1, result ) and result == "xxx" ) );
+        EXPECT_FALSE( tm2, test_id, dict.emplace( 1, "yyy" ) );
+        EXPECT_TRUE( tm2, test_id, ( dict.search( 1, result ) and result == "yyy" ) );
+        EXPECT_FALSE( tm2, test_id, dict.try_emplace( 1, "zzz" ) );
+        EXPECT_TRUE( tm2, test_id, ( dict.search( 1, result ) and result == "yyy" ) );
+        EXPECT_TRUE( tm2, test_id, dict.try_emplace( 2, "BBB" ) );
+        EXPECT_EQUAL( tm2, test_id, dict.size(), 3 );
+
+        DSAL<int, std::string> copy( dict );
+        EXPECT_TRUE( tm2, test_id, ( copy.remove( 2, result ) and result == "BBB" ) );
+        EXPECT_EQUAL( tm2, test_id, dict.size(), 3 );
+        EXPECT_EQUAL( tm2, test_id, copy.size(), 2 );
+
+        DSAL<int, std::string> moved( std::move( dict ) );
+        EXPECT_EQUAL( tm2, test_id, moved.size(), 3 );
+        EXPECT_TRUE( tm2, test_id, dict.empty() );
+        EXPECT_TRUE( tm2, test_id, ( moved.search( 3, result ) and result == std::string( 100, 'a' ) ) );
+        // A moved-from dictionary can be reused.
+        EXPECT_TRUE( tm2, test_id, dict.insert( 9, "III" ) );
+        EXPECT_TRUE( tm2, test_id, ( dict.search( 9, result ) and result == "III" ) );
+
+        copy = moved;
+        EXPECT_EQUAL( tm2, test_id, copy.size(), 3 );
+        copy = std::move( dict );
+        EXPECT_EQUAL( tm2, test_id, copy.size(), 1 );
+        EXPECT_EQUAL( tm2, test_id, copy.min(), 9 );
+    }
+
+    {
+        // Testing the split (structure of arrays) layout.
+        typedef DSAL<int, std::string, std::less<int>, GrowthFactor<2>, SplitLayout> split_dict;
+        split_dict dict(2);
+        std::string result;
+
+        auto test_id{ "SplitLayout" };
+        REGISTER( tm2, test_id, "Testing the dictionary with keys and data stored in separate arrays.");
+        const int keys[] = { 5, 3, 9, 1, 7 };
+        for ( int k : keys ) EXPECT_TRUE( tm2, test_id, dict.insert( k, std::to_string( k ) ) );
+        EXPECT_FALSE( tm2, test_id, dict.insert( 3, "three" ) );
+        EXPECT_EQUAL( tm2, test_id, dict.size(), 5 );
+        EXPECT_EQUAL( tm2, test_id, dict.min(), 1 );
+        EXPECT_EQUAL( tm2, test_id, dict.max(), 9 );
+        EXPECT_TRUE( tm2, test_id, ( dict.search( 3, result ) and result == "three" ) );
+        EXPECT_TRUE( tm2, test_id, ( dict.remove( 5, result ) and result == "5" ) );
+        EXPECT_FALSE( tm2, test_id, dict.search( 5, result ) );
+        EXPECT_TRUE( tm2, test_id, ( dict.search( 7, result ) and result == "7" ) );
+
+        split_dict copy( dict );
+        EXPECT_TRUE( tm2, test_id, ( copy.remove( 1, result ) and result == "1" ) );
+        EXPECT_EQUAL( tm2, test_id, dict.min(), 1 );
+        EXPECT_EQUAL( tm2, test_id, copy.min(), 3 );
+        std::vector< std::pair<int, std::string> > batch{ { 2, "2" }, { 9, "nine" } };
+        EXPECT_EQUAL( tm2, test_id, dict.insert_range( batch.begin(), batch.end() ), 1 );
+        EXPECT_TRUE( tm2, test_id, ( dict.search( 9, result ) and result == "nine" ) );
+        EXPECT_TRUE( tm2, test_id, ( dict.remove( 2, result ) and result == "2" ) );
+        dict.shrink_to_fit();
+        EXPECT_EQUAL( tm2, test_id, dict.capacity(), 4 );
+        EXPECT_TRUE( tm2, test_id, ( dict.search( 9, result ) and result == "nine" ) );
+    }
+
+    {
+        // Testing the frozen (Eytzinger) copy of a sorted dictionary.
+        DSAL<int, int> dict;
+        int result;
+
+        auto test_id{ "Frozen" };
+        REGISTER( tm2, test_id, "Testing lookups on a frozen dictionary against the sorted one it came from.");
+        for ( size_t n = 0; n <= 40; ++n ) {
+            FrozenDictionary<int, int> frozen( dict );
+            EXPECT_EQUAL( tm2, test_id, frozen.size(), n );
+            bool ok = true;
+            int key = 0;
+            for ( int x = -1; x <= 2 * int(n) + 1; ++x ) {
+                // Stored keys are the even numbers in [0, 2n), with data x + 1.
+                bool stored = x >= 0 and x % 2 == 0 and x < 2 * int(n);
+                ok = ok and frozen.search( x, result ) == stored and ( not stored or result == x + 1 );
+                int below = x % 2 == 0 ? x - 2 : x - 1;
+                if ( x < 0 ) below = -1;
+                bool has_pred = below >= 0 and n > 0;
+                if ( below > 2 * int(n) - 2 ) below = 2 * int(n) - 2;
+                ok = ok and frozen.predecessor( x, key ) == has_pred and ( not has_pred or key == below );
+                int above = x < 0 ? 0 : ( x % 2 == 0 ? x + 2 : x + 1 );
+                bool has_succ = above < 2 * int(n);
+                ok = ok and frozen.successor( x, key ) == has_succ and ( not has_succ or key == above );
+            }
+            EXPECT_TRUE( tm2, test_id, ok );
+            if ( n > 0 ) {
+                EXPECT_EQUAL( tm2, test_id, frozen.min(), 0 );
+                EXPECT_EQUAL( tm2, test_id, frozen.max(), 2 * int(n) - 2 );
+            }
+            dict.insert( 2 * int(n), 2 * int(n) + 1 );
+        }
+        FrozenDictionary<int, int> empty( DSAL<int, int>{} );
+        EXPECT_TRUE( tm2, test_id, empty.empty() );
+        EXPECT_FALSE( tm2, test_id, empty.search( 0, result ) );
+    }
+
+    {
+        // Testing the write buffer against std::map.
+        BufferedDSAL<int, int> dict( 4, 8 );
+        std::map<int, int> reference;
+        std::mt19937 g( 13 );
+        std::uniform_int_distribution<int> pick( 0, 299 );
+        int result{0}, key{0};
+        bool ok{ true };
+
+        auto test_id{ "Buffered" };
+        REGISTER( tm2, test_id, "Testing buffered inserts, tombstones and merges against std::map.");
+        for ( int step{0}; step < 5000; ++step ) {
+            int k = pick( g );
+            switch ( step % 6 ) {
+                case 0: case 1:
+                    ok = ok and dict.insert( k, step ) == ( reference.count( k ) == 0 );
+                    reference[k] = step;
+                    break;
+                case 2:
+                    ok = ok and dict.try_emplace( k, -step ) == ( reference.count( k ) == 0 );
+                    reference.insert( { k, -step } );
+                    break;
+                case 3: case 4: {
+                    auto it = reference.find( k );
+                    bool had = it != reference.end();
+                    ok = ok and dict.remove( k, result ) == had and ( not had or result == it->second );
+                    if ( had ) reference.erase( it );
+                    break;
+                }
+                default:
+                    ok = ok and dict.search( k, result ) == ( reference.count( k ) == 1 ) and ( reference.count( k ) == 0 or result == reference[k] );
+                    if ( not reference.empty() ) {
+                        ok = ok and dict.min() == reference.begin()->first and dict.max() == reference.rbegin()->first;
+                    }
+                    break;
+            }
+            ok = ok and dict.size() == reference.size() and dict.buffered() < dict.buffer_limit();
+        }
+        EXPECT_TRUE( tm2, test_id, ok );
+        EXPECT_TRUE( tm2, test_id, ( dict.buffered() > 0 ) );
+        auto it = reference.begin();
+        int second = ( ++it )->first;
+        EXPECT_TRUE( tm2, test_id, ( dict.successor( reference.begin()->first, key ) and key == second ) );
+        EXPECT_EQUAL( tm2, test_id, dict.buffered(), 0 );
+        for ( const auto & e : reference ) ok = ok and dict.search( e.first, result ) and result == e.second;
+        EXPECT_TRUE( tm2, test_id, ok );
+
+        // A DSAL reference would miss the buffer, so only sorted() hands one out, merged.
+        static_assert( not std::is_convertible< BufferedDSAL<int, int> *, DSAL<int, int> * >::value,
+                       "BufferedDSAL must not be usable as a plain DSAL." );
+        dict.insert( 1000, 1 );
+        dict.remove( reference.begin()->first, result );
+        EXPECT_TRUE( tm2, test_id, ( dict.buffered() > 0 ) );
+        const DSAL<int, int> & sorted = dict.sorted();
+        EXPECT_EQUAL( tm2, test_id, dict.buffered(), 0 );
+        EXPECT_EQUAL( tm2, test_id, sorted.size(), dict.size() );
+        EXPECT_TRUE( tm2, test_id, ( sorted.search( 1000, result ) and result == 1 ) );
+        EXPECT_FALSE( tm2, test_id, sorted.contains( reference.begin()->first ) );
+        FrozenDictionary<int, int> frozen( dict.sorted() );
+        EXPECT_EQUAL( tm2, test_id, frozen.size(), dict.size() );
+    }
+
+    {
+        // Testing the parallel bulk build against the serial one.
+        std::vector< std::pair<int, int> > batch( 200000 );
+        std::mt19937 g( 17 );
+        std::uniform_int_distribution<int> pick( 0, 150000 );
+        for ( size_t i{0}; i < batch.size(); ++i ) batch[i] = { pick( g ), static_cast<int>( i ) };
+        DSAL<int, int> serial, parallel, small;
+        serial.assign( batch.begin(), batch.end() );
+        parallel.assign_parallel( batch.begin(), batch.end(), 4 );
+        int a{0}, b{0};
+        bool same{ true };
+        // Binary search only finds every key if the array is sorted.
+        for ( const auto & e : batch ) same = same and serial.search( e.first, a ) and parallel.search( e.first, b ) and a == b;
+
+        auto test_id{ "ParallelBuild" };
+        REGISTER( tm2, test_id, "Testing that the parallel bulk build matches the serial one.");
+        EXPECT_EQUAL( tm2, test_id, parallel.size(), serial.size() );
+        EXPECT_TRUE( tm2, test_id, same );
+        EXPECT_EQUAL( tm2, test_id, parallel.min(), serial.min() );
+        EXPECT_EQUAL( tm2, test_id, parallel.max(), serial.max() );
+        // Small inputs take the serial path.
+        small.assign_parallel( batch.begin(), batch.begin() + 10, 8 );
+        EXPECT_TRUE( tm2, test_id, small.size() <= 10 and small.search( batch[9].first, a ) and a == 9 );
+    }
+
+    {
+        // Testing batched lookups against one search per key, for several array lengths.
+        std::vector< int > keys;
+        for ( int k = 0; k < 203; ++k ) keys.push_back( ( k * 7919 ) % 410 - 5 );
+        bool same{ true };
+        for ( int n : { 0, 1, 2, 7, 64, 100, 200 } ) {
+            DSAL<int, int> dict;
+            for ( int k = 0; k < n; ++k ) dict.insert( 2 * k, k );
+            std::vector< std::pair< bool, int > > result;
+            size_t found = dict.search_many( keys.begin(), keys.end(), std::back_inserter( result ) );
+            size_t expected{ 0 };
+            same = same and result.size() == keys.size();
+            for ( size_t i = 0; same and i < keys.size(); ++i ) {
+                int data{ -1 };
+                bool hit = dict.search( keys[i], data );
+                expected += hit;
+                same = result[i].first == hit and ( not hit or result[i].second == data );
+            }
+            same = same and found == expected;
+        }
+        BufferedDSAL<int, int> buffered( 4, 8 );
+        for ( int k = 0; k < 20; ++k ) buffered.insert( k, k );
+        int removed;
+        buffered.remove( 3, removed );
+        std::vector< std::pair< bool, int > > result;
+        size_t found = buffered.search_many( keys.begin(), keys.begin() + 10, std::back_inserter( result ) );
+        size_t expected{ 0 };
+        for ( size_t i = 0; i < 10; ++i ) {
+            int data{ -1 };
+            bool hit = buffered.search( keys[i], data );
+            expected += hit;
+            same = same and result[i].first == hit and ( not hit or result[i].second == data );
+        }
+
+        auto test_id{ "SearchMany" };
+        REGISTER( tm2, test_id, "Testing that the interleaved search_many matches one search per key.");
+        EXPECT_TRUE( tm2, test_id, same );
+        EXPECT_EQUAL( tm2, test_id, found, expected );
+    }
+
+    {
+        // Testing the ordered queries against std::map, for stored and absent keys.
+        DSAL<int, int, std::less<int>, GrowthFactor<2>, SplitLayout> dict;
+        std::map<int, int> reference;
+        for ( int k = 0; k < 100; ++k ) {
+            dict.insert( 3 * k, k );
+            reference[ 3 * k ] = k;
+        }
+        bool same{ true };
+        int key{ 0 };
+        for ( int x = -2; x < 302; ++x ) {
+            auto lo = reference.lower_bound( x );
+            auto hi = reference.upper_bound( x );
+            auto it = dict.lower_bound( x );
+            same = same and ( lo == reference.end() ? it == dict.end() : it.key() == lo->first and it.data() == lo->second );
+            it = dict.upper_bound( x );
+            same = same and ( hi == reference.end() ? it == dict.end() : it.key() == hi->first );
+            auto eq = dict.equal_range( x );
+            same = same and static_cast< size_t >( eq.second - eq.first ) == reference.count( x );
+            bool has_pred = lo != reference.begin();
+            same = same and dict.predecessor( x, key ) == has_pred and ( not has_pred or key == std::prev( lo )->first );
+            bool has_succ = hi != reference.end();
+            same = same and dict.successor( x, key ) == has_succ and ( not has_succ or key == hi->first );
+        }
+
+        auto test_id{ "RangeQueries" };
+        REGISTER( tm2, test_id, "Testing lower_bound, upper_bound, equal_range, range and predecessor/successor.");
+        EXPECT_TRUE( tm2, test_id, same );
+        auto r = dict.range( 10, 30 );
+        EXPECT_EQUAL( tm2, test_id, r.size(), 7 );
+        int expected{ 12 };
+        for ( auto e : r ) {
+            EXPECT_TRUE( tm2, test_id, ( e.first == expected and e.second == expected / 3 ) );
+            expected += 3;
+        }
+        EXPECT_TRUE( tm2, test_id, dict.range( 30, 10 ).empty() );
+        EXPECT_TRUE( tm2, test_id, dict.range( 1000, 2000 ).empty() );
+        EXPECT_EQUAL( tm2, test_id, static_cast< size_t >( dict.end() - dict.begin() ), dict.size() );
+        EXPECT_TRUE( tm2, test_id, ( dict.sucessor( 3, key ) and key == 6 ) );
+
+        // The buffered DSAL merges its buffer before answering.
+        BufferedDSAL<int, int> buffered( 4, 64 );
+        for ( int k = 10; k > 0; --k ) buffered.insert( k, k );
+        EXPECT_TRUE( tm2, test_id, ( buffered.buffered() > 0 ) );
+        EXPECT_EQUAL( tm2, test_id, buffered.range( 3, 6 ).size(), 4 );
+        EXPECT_EQUAL( tm2, test_id, buffered.buffered(), 0 );
+        EXPECT_TRUE( tm2, test_id, ( buffered.lower_bound( 11 ) == buffered.end() ) );
+        EXPECT_TRUE( tm2, test_id, ( buffered.predecessor( 100, key ) and key == 10 ) );
+    }
+
+    {
+        // Testing the order statistics against a sorted vector.
+        DSAL<int, int> dict;
+        std::vector< int > sorted;
+        for ( int k = 0; k < 200; ++k ) {
+            dict.insert( 5 * k, k );
+            sorted.push_back( 5 * k );
+        }
+        bool same{ true };
+        for ( int x = -3; x < 1003; ++x ) {
+            size_t rank = std::lower_bound( sorted.begin(), sorted.end(), x ) - sorted.begin();
+            size_t upto = std::upper_bound( sorted.begin(), sorted.end(), x + 17 ) - sorted.begin();
+            same = same and dict.rank( x ) == rank and dict.count_range( x, x + 17 ) == upto - rank;
+        }
+        for ( size_t k = 0; k < sorted.size(); ++k ) same = same and dict.select( k ) == sorted[k];
+
+        auto test_id{ "OrderStatistics" };
+        REGISTER( tm2, test_id, "Testing rank, select, count_range and percentile.");
+        EXPECT_TRUE( tm2, test_id, same );
+        EXPECT_EQUAL( tm2, test_id, dict.count_range( 10, 5 ), 0 );
+        EXPECT_EQUAL( tm2, test_id, dict.percentile( 0 ), 0 );
+        EXPECT_EQUAL( tm2, test_id, dict.percentile( 50 ), 495 );
+        EXPECT_EQUAL( tm2, test_id, dict.percentile( 99 ), 985 );
+        EXPECT_EQUAL( tm2, test_id, dict.percentile( 100 ), 995 );
+        bool worked{ false };
+        try {
+            dict.select( 200 );
+        }
+        catch ( std::out_of_range & e )
+        {
+            worked = true;
+        }
+        EXPECT_TRUE( tm2, test_id, worked );
+
+        BufferedDSAL<int, int> buffered( 4, 64 );
+        for ( int k = 10; k > 0; --k ) buffered.insert( k, k );
+        EXPECT_EQUAL( tm2, test_id, buffered.rank( 4 ), 3 );
+        EXPECT_EQUAL( tm2, test_id, buffered.select( 9 ), 10 );
+    }
+
+    {
+        // Testing the lookups that hand out pointers and move data out.
+        DSAL<int, CopyCounted> dict;
+        BufferedDSAL<int, CopyCounted> buffered( 4, 64 );
+        for ( int k = 0; k < 10; ++k ) {
+            dict.emplace( k, k );
+            buffered.emplace( k, k );
+        }
+        buffered.flush();
+        buffered.emplace( 20, 20 );   // Left in the buffer.
+        CopyCounted::copies = 0;
+
+        auto test_id{ "ZeroCopy" };
+        REGISTER( tm2, test_id, "Testing find, contains and extract.");
+        const DSAL<int, CopyCounted> & view = dict;
+        EXPECT_TRUE( tm2, test_id, ( view.find( 4 ) != nullptr and view.find( 4 )->payload[0] == 4 ) );
+        EXPECT_TRUE( tm2, test_id, ( view.find( 40 ) == nullptr ) );
+        EXPECT_TRUE( tm2, test_id, dict.contains( 9 ) );
+        EXPECT_FALSE( tm2, test_id, dict.contains( -1 ) );
+        dict.find( 5 )->payload[0] = 50;
+        CopyCounted out;
+        EXPECT_TRUE( tm2, test_id, ( dict.extract( 5, out ) and out.payload[0] == 50 ) );
+        EXPECT_FALSE( tm2, test_id, dict.contains( 5 ) );
+        EXPECT_TRUE( tm2, test_id, ( dict.remove( 0, out ) and out.payload[0] == 0 ) );
+        EXPECT_EQUAL( tm2, test_id, dict.size(), 8 );
+
+        EXPECT_TRUE( tm2, test_id, ( buffered.find( 20 ) != nullptr and buffered.find( 20 )->payload[0] == 20 ) );
+        EXPECT_TRUE( tm2, test_id, ( buffered.extract( 3, out ) and out.payload[0] == 3 ) );
+        EXPECT_TRUE( tm2, test_id, ( buffered.find( 3 ) == nullptr ) );
+        EXPECT_FALSE( tm2, test_id, buffered.contains( 3 ) );
+        EXPECT_TRUE( tm2, test_id, ( buffered.extract( 20, out ) and out.payload[0] == 20 ) );
+        EXPECT_EQUAL( tm2, test_id, buffered.size(), 9 );
+        EXPECT_EQUAL( tm2, test_id, CopyCounted::copies, 0 );
+
+        // Copies keep the buffer reserved, so a buffered write does not move the entries already there.
+        buffered.emplace( 30, 30 );
+        BufferedDSAL<int, CopyCounted> copy( buffered ), assigned;
+        assigned = buffered;
+        const CopyCounted * a = copy.find( 30 ), * b = assigned.find( 30 );
+        copy.emplace( 31, 31 );
+        assigned.emplace( 31, 31 );
+        EXPECT_TRUE( tm2, test_id, ( copy.find( 30 ) == a and assigned.find( 30 ) == b and a->payload[0] == 30 ) );
+    }
+
+    {
+        // Testing binary snapshots and the mapped dictionary.
+        DSAL<int, double, std::less<int>, GrowthFactor<2>, SplitLayout> dict;
+        for ( int k = 0; k < 5000; ++k ) dict.insert( 7 * k, k / 2.0 );
+        const std::string path{ "dsal_snapshot_test.bin" };
+        dict.save( path );
+        auto mapped = DSAL<int, double>::open_mapped( path );
+
+        bool same{ mapped.size() == dict.size() };
+        int key{ 0 }, other{ 0 };
+        for ( int x = -3; same and x < 35003; x += 3 ) {
+            double a{ 0 }, b{ 0 };
+            same = dict.search( x, a ) == mapped.search( x, b ) and a == b
+                and dict.predecessor( x, key ) == mapped.predecessor( x, other ) and key == other
+                and dict.successor( x, key ) == mapped.successor( x, other ) and key == other;
+        }
+
+        auto test_id{ "Snapshot" };
+        REGISTER( tm2, test_id, "Testing save and open_mapped.");
+        EXPECT_TRUE( tm2, test_id, same );
+        EXPECT_TRUE( tm2, test_id, mapped.verify() );
+        EXPECT_EQUAL( tm2, test_id, mapped.min(), dict.min() );
+        EXPECT_EQUAL( tm2, test_id, mapped.max(), dict.max() );
+        EXPECT_EQUAL( tm2, test_id, mapped.range( 70, 140 ).size(), dict.range( 70, 140 ).size() );
+        EXPECT_TRUE( tm2, test_id, mapped.find( 14 ) != nullptr and *mapped.find( 14 ) == 1.0 );
+        EXPECT_FALSE( tm2, test_id, mapped.contains( 15 ) );
+
+        // Other types, a damaged file and a missing file are all rejected.
+        bool worked{ false };
+        try {
+            DSAL<int, float>::open_mapped( path );
+        }
+        catch ( std::runtime_error & e )
+        {
+            worked = true;
+        }
+        EXPECT_TRUE( tm2, test_id, worked );
+        {
+            std::FILE * file = std::fopen( path.c_str(), "r+b" );
+            std::fseek( file, 200, SEEK_SET );
+            std::fputc( 0x7F, file );
+            std::fclose( file );
+        }
+        EXPECT_FALSE( tm2, test_id, ( DSAL<int, double>::open_mapped( path ).verify() ) );
+        std::remove( path.c_str() );
+        // A header whose offsets would wrap around is rejected, even with a matching header checksum.
+        {
+            DSAL<int, double> small;
+            for ( int k = 0; k < 100; ++k ) small.insert( k, k );
+            small.save( path );
+            dal_snapshot::Header h;
+            std::FILE * file = std::fopen( path.c_str(), "r+b" );
+            worked = std::fread( &h, sizeof( h ), 1, file ) == 1;
+            h.keys_offset = 0 - uint64_t( 64 );
+            h.header_sum = dal_snapshot::header_checksum( h );
+            std::fseek( file, 0, SEEK_SET );
+            worked = worked and std::fwrite( &h, sizeof( h ), 1, file ) == 1;
+            std::fclose( file );
+            EXPECT_TRUE( tm2, test_id, worked );
+            worked = false;
+            try {
+                DSAL<int, double>::open_mapped( path );
+            }
+            catch ( std::runtime_error & e )
+            {
+                worked = true;
+            }
+            EXPECT_TRUE( tm2, test_id, worked );
+            std::remove( path.c_str() );
+        }
+        worked = false;
+        try {
+            DSAL<int, double>::open_mapped( path );
+        }
+        catch ( std::runtime_error & e )
+        {
+            worked = true;
+        }
+        EXPECT_TRUE( tm2, test_id, worked );
+
+        DSAL<int, double> empty;
+        empty.save( path );
+        auto none = DSAL<int, double>::open_mapped( path );
+        EXPECT_TRUE( tm2, test_id, none.empty() and none.verify() and not none.contains( 1 ) );
+        std::remove( path.c_str() );
+
+        // Writes still buffered are merged into the snapshot.
+        BufferedDSAL<int, int> buffered( 16, 8 );
+        for ( int k = 0; k < 10; ++k ) buffered.insert( k, k );
+        buffered.flush();
+        int removed{ 0 };
+        buffered.remove( 3, removed );
+        buffered.insert( 100, 100 );
+        EXPECT_EQUAL( tm2, test_id, buffered.buffered(), 2 );
+        buffered.save( path );
+        auto merged = DSAL<int, int>::open_mapped( path );
+        EXPECT_EQUAL( tm2, test_id, merged.size(), 10 );
+        EXPECT_FALSE( tm2, test_id, merged.contains( 3 ) );
+        EXPECT_TRUE( tm2, test_id, ( merged.find( 100 ) != nullptr and *merged.find( 100 ) == 100 ) );
+        EXPECT_TRUE( tm2, test_id, merged.verify() );
+        std::remove( path.c_str() );
+    }
+
+    {
+        // Testing the streaming loader, with a buffer smaller than some lines.
+        const std::string path{ "dsal_loader_test.csv" };
+        {
+            std::FILE * file = std::fopen( path.c_str(), "wb" );
+            std::fputs( "key,value\n", file );
+            for ( int k = 0; k < 300; ++k ) std::fprintf( file, "%d, %d.5\r\n", 2 * k, k );
+            std::fputs( "\nnot a row\n7,abc\n+8 ,-1.25\n4,40", file ); // Last line has no newline.
+            std::fclose( file );
+        }
+        LoadOptions opt;
+        opt.chunk_bytes = 16;
+        opt.batch = 32;
+        opt.skip_header = true;
+        DSAL<long, double> dict;
+        LoadStats stats = load_dictionary( path, dict, opt );
+
+        bool same{ true };
+        double data{ 0 };
+        for ( int k = 0; k < 300; ++k ) same = same and dict.search( 2 * k, data ) and data == ( k == 2 ? 40 : k == 4 ? -1.25 : k + 0.5 );
+
+        auto test_id{ "Loader" };
+        REGISTER( tm2, test_id, "Testing load_dictionary with bulk inserts, rejected lines and odd line endings.");
+        EXPECT_TRUE( tm2, test_id, same );
+        EXPECT_EQUAL( tm2, test_id, stats.rows, 302 );
+        EXPECT_EQUAL( tm2, test_id, stats.rejected, 2 );
+        EXPECT_EQUAL( tm2, test_id, dict.size(), 300 );
+        EXPECT_FALSE( tm2, test_id, dict.search( 7, data ) );
+
+        // Dictionaries without insert_range get one insert per row; text fields are kept as is.
+        DHT<std::string, std::string> text;
+        DelimitedParser<std::string, std::string> parser;
+        parser.separator = ' ';
+        stats = load_dictionary( path, text, parser );
+        std::string value;
+        EXPECT_EQUAL( tm2, test_id, stats.rows, 302 );
+        EXPECT_TRUE( tm2, test_id, ( text.search( "0,", value ) and value == "0.5" ) );
+        EXPECT_TRUE( tm2, test_id, ( text.search( "not", value ) and value == "a row" ) );
+        std::remove( path.c_str() );
+
+        bool worked{ false };
+        try {
+            load_dictionary( path, dict );
+        }
+        catch ( std::runtime_error & e )
+        {
+            worked = true;
+        }
+        EXPECT_TRUE( tm2, test_id, worked );
+    }
+
+    {
+        // Testing the operation counters of the sorted array and the write buffer.
+        DSAL<int, int> dict( 4 );
+        for ( int k = 0; k < 8; ++k ) dict.insert( k, k );
+
+        auto test_id{ "Stats" };
+        REGISTER( tm2, test_id, "Testing the operation counters and reset_stats.");
+        DictionaryStats s = dict.stats();
+        EXPECT_EQUAL( tm2, test_id, s.inserts, 8 );
+        EXPECT_EQUAL( tm2, test_id, s.moves, 4 ); // Appends shift nothing; only the 4 -> 8 resize moves.
+        EXPECT_EQUAL( tm2, test_id, s.resizes, 1 );
+
+        dict.reset_stats();
+        int data{ 0 };
+        dict.insert( -1, 0 );          // Full: 8 moved by the resize, then 8 shifted right.
+        dict.remove( 3, data );        // Index 4 of 9: 4 shifted left.
+        s = dict.stats();
+        EXPECT_EQUAL( tm2, test_id, s.resizes, 1 );
+        EXPECT_EQUAL( tm2, test_id, s.moves, 8 + 8 + 4 );
+        EXPECT_EQUAL( tm2, test_id, s.bytes_allocated, 16 * sizeof( std::pair<int, int> ) );
+        EXPECT_EQUAL( tm2, test_id, s.inserts, 1 );
+        EXPECT_EQUAL( tm2, test_id, s.remove_hits, 1 );
+
+        // Binary searches compare at most floor(log2 n) + 2 keys per lookup.
+        DSAL<int, int> big;
+        for ( int k = 0; k < 1000; ++k ) big.insert( k, k );
+        big.reset_stats();
+        for ( int k = 0; k < 1000; ++k ) big.search( 2 * k, data );
+        s = big.stats();
+        EXPECT_EQUAL( tm2, test_id, s.lookup_hits, 500 );
+        EXPECT_EQUAL( tm2, test_id, s.lookup_misses, 500 );
+        EXPECT_TRUE( tm2, test_id, s.comparisons >= 1000 * 9 and s.comparisons <= 1000 * 11 );
+        big.reset_stats();
+        std::vector<int> keys{ -1, 0, 1, 2, 999, 1000, 5, 6, 7, 8 };
+        std::vector< std::pair<bool, int> > found;
+        big.search_many( keys.begin(), keys.end(), std::back_inserter( found ) );
+        EXPECT_EQUAL( tm2, test_id, big.stats().lookup_hits, 8 );
+        EXPECT_EQUAL( tm2, test_id, big.stats().lookup_misses, 2 );
+
+        // Each buffered lookup is counted once, whether the delta or the sorted array answers it.
+        BufferedDSAL<int, int> buffered( 16, 4 );
+        for ( int k = 0; k < 6; ++k ) buffered.insert( k, k );
+        buffered.reset_stats();
+        for ( int k = 0; k < 8; ++k ) buffered.search( k, data );
+        buffered.remove( 1, data );
+        buffered.find( 1 );
+        s = buffered.stats();
+        EXPECT_EQUAL( tm2, test_id, s.lookup_hits, 6 );
+        EXPECT_EQUAL( tm2, test_id, s.lookup_misses, 3 );
+        EXPECT_EQUAL( tm2, test_id, s.remove_hits, 1 );
+    }
+
+    {
+        // Testing that a recorded workload replays to the same results on other implementations.
+        const std::string path = "dal_test_trace.bin";
+        int data{ 0 }, key{ 0 };
+        bool same{ true };
+        {
+            RecordingDictionary< DSAL<int, int> > dict( path );
+            std::mt19937 g( 3 );
+            for ( int step = 0; step < 3000; ++step ) {
+                int k = static_cast< int >( g() % 500 );
+                switch ( g() % 6 ) {
+                    case 0: case 1: dict.insert( k, step ); break;
+                    case 2: dict.search( k, data ); break;
+                    case 3: dict.remove( k, data ); break;
+                    case 4: dict.predecessor( k, key ); break;
+                    default: if ( not dict.empty() ) dict.min(); dict.successor( k, key );
+                }
+            }
+            same = dict.trace().events() > 3000;
+            dict.trace().close();
+        }
+        auto events = read_trace< int, int >( path );
+        DSAL<int, int> sorted;
+        DAL<int, int> unsorted;
+        BlockedDictionary<int, int> blocked;
+        ReplayStats a = replay_trace( events, sorted );
+        ReplayStats b = replay_trace( events, unsorted, false );
+        ReplayStats c = replay_trace( events, blocked );
+
+        auto test_id{ "Trace" };
+        REGISTER( tm2, test_id, "Testing record, read_trace and replay_trace across implementations.");
+        EXPECT_TRUE( tm2, test_id, same );
+        EXPECT_EQUAL( tm2, test_id, a.events, events.size() );
+        EXPECT_EQUAL( tm2, test_id, a.op_events[dal_trace::MAX], 0 );
+        EXPECT_EQUAL( tm2, test_id, a.latency[dal_trace::SEARCH].count(), a.op_events[dal_trace::SEARCH] );
+        EXPECT_TRUE( tm2, test_id, b.latency[dal_trace::SEARCH].empty() );
+        EXPECT_TRUE( tm2, test_id, ( a.checksum == b.checksum and a.checksum == c.checksum ) );
+        EXPECT_EQUAL( tm2, test_id, sorted.size(), unsorted.size() );
+
+        // A dictionary that answers some calls differently changes the checksums of those calls.
+        DSAL<int, int> other;
+        other.insert( 100000, 0 );
+        ReplayStats d = replay_trace( events, other );
+        EXPECT_TRUE( tm2, test_id, ( d.checksum != a.checksum ) );
+        EXPECT_TRUE( tm2, test_id, ( d.op_checksum[dal_trace::MIN] == a.op_checksum[dal_trace::MIN] ) );
+        EXPECT_TRUE( tm2, test_id, ( d.op_checksum[dal_trace::SUCCESSOR] != a.op_checksum[dal_trace::SUCCESSOR] ) );
+
+        // Traces of other types and truncated traces are refused.
+        bool worked{ false };
+        try {
+            read_trace< long, int >( path );
+        }
+        catch ( std::runtime_error & e )
+        {
+            worked = true;
+        }
+        EXPECT_TRUE( tm2, test_id, worked );
+        std::FILE * file = std::fopen( path.c_str(), "ab" );
+        std::fputc( dal_trace::INSERT, file );
+        std::fclose( file );
+        worked = false;
+        try {
+            read_trace< int, int >( path );
+        }
+        catch ( std::runtime_error & e )
+        {
+            worked = true;
+        }
+        EXPECT_TRUE( tm2, test_id, worked );
+        std::remove( path.c_str() );
+    }
+
+    // Creates a test manager for the DHT class.
+    TestManager tm3{ "DHT<int, string> Suite" };
+
+    {
+        // Testing the basic operations of the hash dictionary.
+        DHT<int, std::string> dict(4);
+        std::string result;
+        int key;
+
+        auto test_id{ "BasicOperations" };
+        REGISTER( tm3, test_id, "Testing insert, search, remove and the ordered operations.");
+        EXPECT_TRUE( tm3, test_id, dict.empty() );
+        EXPECT_FALSE( tm3, test_id, dict.search( 1, result ) );
+        bool worked{ false };
+        try {
+            key = dict.min();
+        }
+        catch ( std::out_of_range & e )
+        {
+            worked = true;
+        }
+        EXPECT_TRUE( tm3, test_id, worked );
+        const int keys[] = { 50, 20, 80, 10, 30, 70, 90 };
+        for ( int k : keys ) EXPECT_TRUE( tm3, test_id, dict.insert( k, std::to_string( k ) ) );
+        EXPECT_FALSE( tm3, test_id, dict.insert( 20, "twenty" ) );
+        EXPECT_EQUAL( tm3, test_id, dict.size(), 7 );
+        EXPECT_TRUE( tm3, test_id, ( dict.search( 20, result ) and result == "twenty" ) );
+        EXPECT_EQUAL( tm3, test_id, dict.min(), 10 );
+        EXPECT_EQUAL( tm3, test_id, dict.max(), 90 );
+        EXPECT_TRUE( tm3, test_id, ( dict.predecessor( 50, key ) and key == 30 ) );
+        EXPECT_TRUE( tm3, test_id, ( dict.predecessor( 55, key ) and key == 50 ) );
+        EXPECT_FALSE( tm3, test_id, dict.predecessor( 10, key ) );
+        EXPECT_TRUE( tm3, test_id, ( dict.successor( 50, key ) and key == 70 ) );
+        EXPECT_FALSE( tm3, test_id, dict.successor( 90, key ) );
+        EXPECT_TRUE( tm3, test_id, ( dict.remove( 50, result ) and result == "50" ) );
+        EXPECT_FALSE( tm3, test_id, dict.remove( 50, result ) );
+        EXPECT_FALSE( tm3, test_id, dict.search( 50, result ) );
+        EXPECT_FALSE( tm3, test_id, dict.try_emplace( 10, "ten" ) );
+        EXPECT_TRUE( tm3, test_id, ( dict.search( 10, result ) and result == "10" ) );
+        EXPECT_TRUE( tm3, test_id, dict.emplace( 60, 3, 'x' ) );
+        EXPECT_TRUE( tm3, test_id, ( dict.search( 60, result ) and result == "xxx" ) );
+    }
+
+    {
+        // Testing many insertions and removals against a reference.
+        DHT<int, int> dict;
+        std::vector<int> present( 4000, -1 );
+        std::mt19937 g( 7 );
+        std::uniform_int_distribution<int> pick( 0, 3999 );
+        int result{0};
+        size_t count{0};
+        bool ok{ true };
+
+        auto test_id{ "RandomOperations" };
+        REGISTER( tm3, test_id, "Testing random inserts and removals, with rehashing and backward shifts.");
+        for ( int step{0}; step < 40000; ++step ) {
+            int k = pick( g );
+            if ( step % 3 == 2 ) {
+                bool had = present[k] >= 0;
+                ok = ok and dict.remove( k, result ) == had and ( not had or result == present[k] );
+                if ( had ) { present[k] = -1; --count; }
+            } else {
+                bool fresh = present[k] < 0;
+                ok = ok and dict.insert( k, step ) == fresh;
+                if ( fresh ) ++count;
+                present[k] = step;
+            }
+        }
+        for ( int k{0}; k < 4000; ++k )
+            ok = ok and dict.search( k, result ) == ( present[k] >= 0 ) and ( present[k] < 0 or result == present[k] );
+        EXPECT_TRUE( tm3, test_id, ok );
+        EXPECT_EQUAL( tm3, test_id, dict.size(), count );
+    }
+
+    {
+        // Testing copy, move and the lifetime of the stored data.
+        Counted::alive = 0;
+        {
+            DHT<int, Counted> dict(2);
+            for ( int i{0}; i < 100; ++i ) dict.insert( i, Counted( i ) );
+            DHT<int, Counted> copy( dict );
+            DHT<int, Counted> moved( std::move( dict ) );
+            Counted result;
+
+            auto test_id{ "CopyMove" };
+            REGISTER( tm3, test_id, "Testing copy and move construction and that every entry is destroyed.");
+            EXPECT_TRUE( tm3, test_id, dict.empty() );
+            EXPECT_TRUE( tm3, test_id, dict.insert( 1, Counted( 1 ) ) );
+            EXPECT_TRUE( tm3, test_id, ( copy.remove( 42, result ) and result.value == 42 ) );
+            EXPECT_TRUE( tm3, test_id, ( moved.search( 42, result ) and result.value == 42 ) );
+            EXPECT_EQUAL( tm3, test_id, copy.size(), 99 );
+            EXPECT_EQUAL( tm3, test_id, moved.size(), 100 );
+            copy = moved;
+            EXPECT_EQUAL( tm3, test_id, copy.size(), 100 );
+        }
+        auto test_id{ "CopyMove" };
+        EXPECT_EQUAL( tm3, test_id, Counted::alive, 0 );
+    }
+
+    // Creates a test manager for the BlockedDictionary class.
+    TestManager tm4{ "BlockedDictionary<int, int> Suite" };
+
+    {
+        // Testing random operations against std::map, with small blocks so they split and merge often.
+        BlockedDictionary<int, int, std::less<int>, 8> dict;
+        std::map<int, int> reference;
+        std::mt19937 g( 11 );
+        std::uniform_int_distribution<int> pick( 0, 999 );
+        int result{0}, key{0};
+        bool ok{ true };
+
+        auto test_id{ "RandomOperations" };
+        REGISTER( tm4, test_id, "Testing random inserts, removals and queries against std::map.");
+        for ( int step{0}; step < 20000; ++step ) {
+            int k = pick( g );
+            if ( step % 5 < 2 ) {
+                bool had = reference.erase( k ) > 0;
+                ok = ok and dict.remove( k, result ) == had;
+            } else if ( step % 5 < 4 ) {
+                ok = ok and dict.insert( k, step ) == ( reference.count( k ) == 0 );
+                reference[k] = step;
+            } else {
+                auto it = reference.lower_bound( k );
+                bool has_pred = it != reference.begin();
+                ok = ok and dict.predecessor( k, key ) == has_pred and ( not has_pred or key == std::prev( it )->first );
+                it = reference.upper_bound( k );
+                bool has_succ = it != reference.end();
+                ok = ok and dict.successor( k, key ) == has_succ and ( not has_succ or key == it->first );
+            }
+        }
+        for ( const auto & e : reference ) ok = ok and dict.search( e.first, result ) and result == e.second;
+        EXPECT_TRUE( tm4, test_id, ok );
+        EXPECT_EQUAL( tm4, test_id, dict.size(), reference.size() );
+        EXPECT_EQUAL( tm4, test_id, dict.min(), reference.begin()->first );
+        EXPECT_EQUAL( tm4, test_id, dict.max(), reference.rbegin()->first );
+    }
+
+    {
+        // Testing bulk loading, copies and the empty dictionary.
+        std::vector< std::pair<int, int> > batch;
+        for ( int i{0}; i < 100; ++i ) batch.emplace_back( ( i * 37 ) % 100, i );
+        batch.emplace_back( 5, -5 );
+        BlockedDictionary<int, int, std::less<int>, 8> dict( batch.begin(), batch.end() );
+        int result{0}, key{0};
+
+        auto test_id{ "BulkLoad" };
+        REGISTER( tm4, test_id, "Testing the range constructor, copies and the empty dictionary.");
+        EXPECT_EQUAL( tm4, test_id, dict.size(), 100 );
+        EXPECT_TRUE( tm4, test_id, dict.search( 5, result ) and result == -5 );
+        EXPECT_EQUAL( tm4, test_id, dict.min(), 0 );
+        EXPECT_EQUAL( tm4, test_id, dict.max(), 99 );
+        auto copy = dict;
+        for ( int i{0}; i < 100; ++i ) EXPECT_TRUE( tm4, test_id, copy.remove( i, result ) );
+        EXPECT_TRUE( tm4, test_id, copy.empty() );
+        EXPECT_FALSE( tm4, test_id, copy.predecessor( 10, key ) );
+        EXPECT_FALSE( tm4, test_id, copy.successor( 10, key ) );
+        EXPECT_TRUE( tm4, test_id, copy.insert( 3, 3 ) );
+        EXPECT_EQUAL( tm4, test_id, copy.min(), 3 );
+        EXPECT_EQUAL( tm4, test_id, dict.size(), 100 );
+    }
+
+    // Creates a test manager for the ShardedDictionary class.
+    TestManager tm5{ "ShardedDictionary<DSAL<int, int>, 8> Suite" };
+
+    {
+        // Testing concurrent writers and readers.
+        ShardedDictionary< DSAL<int, int>, 8 > dict;
+        const int per_thread{ 2000 };
+        std::vector< std::thread > pool;
+        std::vector< int > bad( 4, 0 );
+        for ( int t{0}; t < 4; ++t ) {
+            pool.emplace_back( [&dict, &bad, t, per_thread]() {
+                int result{0};
+                // Each writer owns the keys congruent to t modulo 4.
+                for ( int i{0}; i < per_thread; ++i ) {
+                    int k = 4 * i + t;
+                    if ( not dict.insert( k, -k ) ) ++bad[t];
+                    if ( not dict.search( k, result ) or result != -k ) ++bad[t];
+                    if ( i % 2 and not dict.remove( k, result ) ) ++bad[t];
+                }
+            } );
+        }
+        for ( auto & th : pool ) th.join();
+        int result{0};
+
+        auto test_id{ "Concurrent" };
+        REGISTER( tm5, test_id, "Testing inserts, searches and removals from several threads.");
+        EXPECT_EQUAL( tm5, test_id, bad[0] + bad[1] + bad[2] + bad[3], 0 );
+        EXPECT_EQUAL( tm5, test_id, dict.size(), 4 * per_thread / 2 );
+        EXPECT_EQUAL( tm5, test_id, dict.min(), 0 );
+        EXPECT_EQUAL( tm5, test_id, dict.max(), 4 * ( per_thread - 2 ) + 3 );
+        EXPECT_TRUE( tm5, test_id, ( dict.search( 8, result ) and result == -8 ) );
+        EXPECT_FALSE( tm5, test_id, dict.search( 4, result ) );
+        EXPECT_TRUE( tm5, test_id, ( dict.remove( 8, result ) and result == -8 ) );
+        EXPECT_FALSE( tm5, test_id, dict.empty() );
+    }
+
+    {
+        // Testing concurrent min/max on DAL shards whose extremes were removed: const reads must not refill a cache.
+        ShardedDictionary< DAL<int, int>, 2 > dict;
+        int result{0};
+        for ( int k{0}; k < 1000; ++k ) dict.insert( k, k );
+        for ( int k : { 0, 1, 998, 999 } ) dict.remove( k, result );
+        std::vector< std::thread > pool;
+        std::vector< int > bad( 4, 0 );
+        for ( int t{0}; t < 4; ++t ) {
+            pool.emplace_back( [&dict, &bad, t]() {
+                for ( int i{0}; i < 500; ++i )
+                    if ( dict.min() != 2 or dict.max() != 997 ) ++bad[t];
+            } );
+        }
+        for ( auto & th : pool ) th.join();
+
+        auto test_id{ "ConcurrentExtremes" };
+        REGISTER( tm5, test_id, "Testing min and max of DAL shards from several threads.");
+        EXPECT_EQUAL( tm5, test_id, bad[0] + bad[1] + bad[2] + bad[3], 0 );
+        EXPECT_TRUE( tm5, test_id, ( dict.remove( 2, result ) and dict.min() == 3 ) );
+    }
+
+    // Creates a test manager for the SnapshotDictionary class.
+    TestManager tm6{ "SnapshotDictionary<DSAL<int, int>> Suite" };
+
+    {
+        // Testing that readers only ever see whole batches while a writer publishes new ones.
+        typedef SnapshotDictionary< DSAL<int, int>, 8 > snap_dict;
+        snap_dict dict;
+        std::atomic<bool> done{ false };
+        std::vector< int > bad( 3, 0 );
+        std::vector< std::thread > readers;
+        for ( int t{0}; t < 3; ++t ) {
+            readers.emplace_back( [&dict, &done, &bad, t]() {
+                auto reader = dict.reader();
+                while ( not done.load() ) {
+                    bool whole = reader.read( []( const DSAL<int, int> & d ) {
+                        // Batches insert 10 consecutive keys, so a snapshot holds [0, size).
+                        int last{0};
+                        return d.size() % 10 == 0 and ( d.empty() or ( d.min() == 0 and d.max() == int( d.size() ) - 1
+                               and d.search( int( d.size() ) / 2, last ) and last == int( d.size() ) / 2 ) );
+                    } );
+                    if ( not whole ) ++bad[t];
+                }
+            } );
+        }
+        for ( int batch{0}; batch < 200; ++batch ) {
+            dict.update( [batch]( DSAL<int, int> & d ) {
+                for ( int k{10 * batch}; k < 10 * batch + 10; ++k ) d.insert( k, k );
+            } );
+        }
+        done = true;
+        for ( auto & th : readers ) th.join();
+        int result{0};
+
+        auto test_id{ "ConcurrentReaders" };
+        REGISTER( tm6, test_id, "Testing lock-free readers against a writer publishing batches.");
+        EXPECT_EQUAL( tm6, test_id, bad[0] + bad[1] + bad[2], 0 );
+        auto reader = dict.reader();
+        EXPECT_EQUAL( tm6, test_id, reader.size(), 2000 );
+        EXPECT_EQUAL( tm6, test_id, dict.retired(), 0 );
+        EXPECT_TRUE( tm6, test_id, dict.insert( 5000, 1 ) );
+        EXPECT_TRUE( tm6, test_id, dict.remove( 7, result ) and result == 7 );
+        EXPECT_FALSE( tm6, test_id, reader.search( 7, result ) );
+        EXPECT_EQUAL( tm6, test_id, reader.max(), 5000 );
+        std::vector< snap_dict::Reader > all;
+        for ( int i{0}; i < 7; ++i ) all.push_back( dict.reader() );
+        bool worked{ false };
+        try {
+            dict.reader();
+        }
+        catch ( std::runtime_error & e )
+        {
+            worked = true;
+        }
+        EXPECT_TRUE( tm6, test_id, worked );
+    }
+
+    // Creates a test manager for the LatencyHistogram class.
+    TestManager tm7{ "LatencyHistogram Suite" };
+
+    {
+        // Testing the bucket bounds and the percentiles of a known distribution.
+        std::mt19937_64 g( 5 );
+        bool bounded{ true };
+        for ( int i{0}; i < 100000; ++i ) {
+            uint64_t v = g() >> ( g() % 64 );
+            uint64_t top = LatencyHistogram::highest( LatencyHistogram::bucket( v ) );
+            bounded = bounded and top >= v and top - v <= v / 32;
+        }
+        LatencyHistogram h;
+        for ( uint64_t v{1}; v <= 1000; ++v ) h.record( v );
+
+        auto test_id{ "Percentiles" };
+        REGISTER( tm7, test_id, "Testing bucket bounds, percentiles, merge and the reports.");
+        EXPECT_TRUE( tm7, test_id, bounded );
+        EXPECT_EQUAL( tm7, test_id, h.count(), 1000 );
+        EXPECT_EQUAL( tm7, test_id, h.min(), 1 );
+        EXPECT_EQUAL( tm7, test_id, h.max(), 1000 );
+        EXPECT_EQUAL( tm7, test_id, h.percentile( 0 ), 1 );
+        EXPECT_EQUAL( tm7, test_id, h.percentile( 2 ), 20 ); // Small values are exact.
+        EXPECT_EQUAL( tm7, test_id, h.percentile( 100 ), 1000 );
+        EXPECT_TRUE( tm7, test_id, ( h.percentile( 50 ) >= 500 and h.percentile( 50 ) <= 500 + 500 / 32 ) );
+        EXPECT_TRUE( tm7, test_id, ( h.percentile( 99.9 ) >= 999 and h.percentile( 99.9 ) <= 1000 ) );
+        EXPECT_TRUE( tm7, test_id, ( h.mean() == 500.5 ) );
+
+        // Histograms filled by two threads merge into the one a single thread would fill.
+        LatencyHistogram part[2], whole;
+        std::vector< std::thread > pool;
+        for ( int t{0}; t < 2; ++t )
+            pool.emplace_back( [&part, t]() { for ( uint64_t v = t; v < 100000; v += 2 ) part[t].record( v * v ); } );
+        for ( auto & th : pool ) th.join();
+        for ( uint64_t v{0}; v < 100000; ++v ) whole.record( v * v );
+        part[0].merge( part[1] );
+        bool same{ part[0].count() == whole.count() and part[0].max() == whole.max() and part[0].mean() == whole.mean() };
+        for ( double p : { 0.0, 10.0, 50.0, 90.0, 99.0, 99.9, 100.0 } ) same = same and part[0].percentile( p ) == whole.percentile( p );
+        EXPECT_TRUE( tm7, test_id, same );
+
+        std::ostringstream text, json;
+        h.write_text( text, "search" );
+        h.write_json( json );
+        EXPECT_EQUAL( tm7, test_id, text.str().substr( 0, 18 ), "search count=1000 " );
+        EXPECT_TRUE( tm7, test_id, ( json.str().find( "\"max_ns\":1000}" ) != std::string::npos ) );
+        h.reset();
+        EXPECT_TRUE( tm7, test_id, h.empty() );
+        bool worked{ false };
+        try {
+            h.percentile( 50 );
+        }
+        catch ( std::out_of_range & e )
+        {
+            worked = true;
+        }
+        EXPECT_TRUE( tm7, test_id, worked );
+    }
+
+    {
+        // Testing the wrapper that times each operation.
+        TimedDictionary< DSAL<int, int> > dict;
+        int data{ 0 };
+        for ( int k{0}; k < 1000; ++k ) dict.insert( k, k );
+        for ( int k{0}; k < 500; ++k ) dict.search( 2 * k, data );
+        bool removed = dict.remove( 10, data ) and data == 10;
+
+        auto test_id{ "TimedDictionary" };
+        REGISTER( tm7, test_id, "Testing that the wrapper records one latency per call.");
+        EXPECT_TRUE( tm7, test_id, removed );
+        EXPECT_EQUAL( tm7, test_id, dict.size(), 999 );
+        EXPECT_EQUAL( tm7, test_id, dict.insert_latency().count(), 1000 );
+        EXPECT_EQUAL( tm7, test_id, dict.search_latency().count(), 500 );
+        EXPECT_EQUAL( tm7, test_id, dict.remove_latency().count(), 1 );
+        EXPECT_TRUE( tm7, test_id, ( dict.insert_latency().percentile( 50 ) <= dict.insert_latency().max() ) );
+        EXPECT_TRUE( tm7, test_id, dict.dictionary().contains( 11 ) );
+        std::ostringstream json;
+        dict.write_json( json );
+        EXPECT_TRUE( tm7, test_id, ( json.str().find( "\"remove\":{\"count\":1," ) != std::string::npos ) );
+        dict.reset_latencies();
+        EXPECT_TRUE( tm7, test_id, dict.insert_latency().empty() and dict.search_latency().empty() );
+    }
+
     tm.summary();
     std::cout << std::endl;
     tm2.summary();
+    std::cout << std::endl;
+    tm3.summary();
+    std::cout << std::endl;
+    tm4.summary();
+    std::cout << std::endl;
+    tm5.summary();
+    std::cout << std::endl;
+    tm6.summary();
+    std::cout << std::endl;
+    tm7.summary();
     return EXIT_SUCCESS;
 }